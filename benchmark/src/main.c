@@ -0,0 +1,426 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <GLES/gl.h>
+
+#include "null_driver.h"
+
+// ERR Comes From The Layer's log.h
+#define INFO(format, ...) \
+    { \
+        fprintf(stderr, "[INFO]: " format "\n", ##__VA_ARGS__); \
+    }
+
+// Time
+static uint64_t get_time() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return ((uint64_t) time.tv_sec * 1000000000ull) + time.tv_nsec;
+}
+
+// Shared Data
+static const GLfloat quad[] = {
+    0, 0, 0,
+    1, 0, 0,
+    0, 1, 0,
+    1, 0, 0,
+    1, 1, 0,
+    0, 1, 0
+};
+static const GLubyte quad_colors[] = {
+    255, 0, 0, 255,
+    0, 255, 0, 255,
+    0, 0, 255, 255,
+    0, 255, 0, 255,
+    255, 255, 255, 255,
+    0, 0, 255, 255
+};
+static const GLushort quad_indices[] = {0, 1, 2, 3, 4, 5};
+static GLuint buffer;
+static GLuint texture;
+static GLuint list;
+
+// Setup
+static void setup_buffer() {
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof (quad), quad, GL_STATIC_DRAW);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, NULL);
+}
+static void setup_client_arrays() {
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, quad);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glColorPointer(4, GL_UNSIGNED_BYTE, 0, quad_colors);
+}
+static void setup_sprites() {
+    setup_buffer();
+    glGenTextures(1, &texture);
+    glEnable(GL_TEXTURE_2D);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, 3 * sizeof (GLfloat), NULL);
+}
+static void setup_deferred_sprites() {
+    setup_sprites();
+    set_gles_compatibility_layer_deferred_draws(1);
+}
+static void setup_elements() {
+    setup_buffer();
+    GLuint element_buffer;
+    glGenBuffers(1, &element_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof (quad_indices), quad_indices, GL_STATIC_DRAW);
+}
+static void setup_list() {
+    setup_client_arrays();
+    list = glGenLists(1);
+    glNewList(list, GL_COMPILE);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glEndList();
+}
+
+// Draws (The Setup Decides Where The Vertices Come From)
+static void draw_arrays(const long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+}
+static void draw_moving_buffer(const long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        glPushMatrix();
+        glTranslatef(i & 255, 0, 0);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        glPopMatrix();
+    }
+}
+static void draw_sprites(const long iterations) {
+    // Typical Sprite Loop: Redundant Binds And A Small Draw
+    for (long i = 0; i < iterations; i++) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glColor4f(1, 1, 1, 1);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+}
+static void draw_elements(const long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, NULL);
+    }
+}
+static void draw_immediate(const long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        glBegin(GL_QUADS);
+        glVertex2f(0, 0);
+        glVertex2f(1, 0);
+        glVertex2f(1, 1);
+        glVertex2f(0, 1);
+        glEnd();
+    }
+}
+static void call_list(const long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        glCallList(list);
+    }
+}
+
+// Matrices
+static void matrix_stack(const long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        glPushMatrix();
+        glTranslatef(1, 2, 3);
+        glRotatef(45, 0, 0, 1);
+        glScalef(2, 2, 2);
+        glPopMatrix();
+    }
+}
+static void mult_matrix(const long iterations) {
+    static const GLfloat matrix[16] = {
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, 1, 0,
+        1, 2, 3, 1
+    };
+    for (long i = 0; i < iterations; i++) {
+        glLoadIdentity();
+        glMultMatrixf(matrix);
+    }
+}
+
+// State
+static void redundant_state(const long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+    }
+}
+static void changing_state(const long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        if (i & 1) {
+            glEnable(GL_BLEND);
+        } else {
+            glDisable(GL_BLEND);
+        }
+        glBlendFunc(GL_SRC_ALPHA, (i & 1) ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(i & 1);
+    }
+}
+static void passthrough(const long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        glLineWidth(1 + (i & 1));
+        glPolygonOffset(i & 1, 0);
+    }
+}
+
+// Benchmarks
+typedef struct {
+    const char *name;
+    void (*setup)();
+    void (*run)(long iterations);
+} benchmark_t;
+static const benchmark_t benchmarks[] = {
+    {"glDrawArrays (Buffer)", setup_buffer, draw_arrays},
+    {"glDrawArrays (Client Arrays)", setup_client_arrays, draw_arrays},
+    {"glDrawArrays (Moving)", setup_buffer, draw_moving_buffer},
+    {"glDrawArrays (Sprites)", setup_sprites, draw_sprites},
+    {"glDrawArrays (Deferred Sprites)", setup_deferred_sprites, draw_sprites},
+    {"glDrawElements (Buffer)", setup_elements, draw_elements},
+    {"glBegin/glEnd (Quad)", NULL, draw_immediate},
+    {"glCallList", setup_list, call_list},
+    {"Matrix Stack", NULL, matrix_stack},
+    {"glMultMatrixf", NULL, mult_matrix},
+    {"State (Redundant)", NULL, redundant_state},
+    {"State (Changing)", NULL, changing_state},
+    {"Passthrough", NULL, passthrough}
+};
+#define BENCHMARKS_SIZE ((int) (sizeof (benchmarks) / sizeof (benchmarks[0])))
+
+// Results
+typedef struct {
+    double ns_per_op;
+    double calls_per_op;
+} result_t;
+
+// Options
+static int threaded = 0;
+static uint64_t min_time = 200000000;
+static int repetitions = 3;
+static void thread_callback(__attribute__((unused)) void *data, __attribute__((unused)) GLboolean current) {
+}
+
+// Run
+static result_t measure(const benchmark_t *benchmark, const long iterations) {
+    // Fresh Context
+    init_gles_compatibility_layer(get_null_driver_proc_address);
+    if (benchmark->setup != NULL) {
+        benchmark->setup();
+    }
+    if (threaded) {
+        start_gles_compatibility_layer_thread(thread_callback, NULL);
+    }
+    // Warm Up (Compiles Shader Variants, Grows Buffers)
+    benchmark->run(16);
+    glFinish();
+
+    // Measure (glFinish Flushes Deferred Work And Waits For The Submission Thread, Its Own Call Is Not Counted)
+    const uint64_t start_calls = get_null_driver_total_calls();
+    const uint64_t start = get_time();
+    benchmark->run(iterations);
+    glFinish();
+    const uint64_t time = get_time() - start;
+    const uint64_t calls = get_null_driver_total_calls() - start_calls - 1;
+    if (threaded) {
+        stop_gles_compatibility_layer_thread();
+    }
+    const result_t result = {
+        .ns_per_op = (double) time / iterations,
+        .calls_per_op = (double) calls / iterations
+    };
+    return result;
+}
+static result_t run(const benchmark_t *benchmark) {
+    // Find An Iteration Count That Runs Long Enough
+    long iterations = 1024;
+    while ((double) iterations * measure(benchmark, iterations).ns_per_op < min_time) {
+        iterations *= 2;
+    }
+    // Keep The Fastest Run
+    result_t best = measure(benchmark, iterations);
+    for (int i = 1; i < repetitions; i++) {
+        const result_t result = measure(benchmark, iterations);
+        if (result.ns_per_op < best.ns_per_op) {
+            best = result;
+        }
+    }
+    return best;
+}
+
+// Baselines
+// One Line Per Benchmark: name<TAB>ns/op<TAB>calls/op
+static void save_baseline(const char *path, const result_t *results) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        ERR("Unable To Write Baseline: %s", path);
+    }
+    for (int i = 0; i < BENCHMARKS_SIZE; i++) {
+        fprintf(file, "%s\t%f\t%f\n", benchmarks[i].name, results[i].ns_per_op, results[i].calls_per_op);
+    }
+    fclose(file);
+}
+static int load_baseline(const char *path, result_t *baseline, int *found) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    char line[256];
+    while (fgets(line, sizeof (line), file) != NULL) {
+        char *ns = strchr(line, '\t');
+        if (ns == NULL) {
+            continue;
+        }
+        *ns++ = '\0';
+        for (int i = 0; i < BENCHMARKS_SIZE; i++) {
+            if (strcmp(line, benchmarks[i].name) == 0 && sscanf(ns, "%lf\t%lf", &baseline[i].ns_per_op, &baseline[i].calls_per_op) == 2) {
+                found[i] = 1;
+            }
+        }
+    }
+    fclose(file);
+    return 1;
+}
+
+// Checks
+// Deferred Draws Must Reach The Driver As The Same Primitives
+typedef struct {
+    GLenum mode;
+    GLint first[3];
+    GLsizei count[3];
+    GLsizei size;
+    // Expected Submission
+    GLint submitted_first[3];
+    GLsizei submitted_count[3];
+    GLsizei submitted_size;
+} deferred_check_t;
+static const deferred_check_t deferred_checks[] = {
+    // Whole Triangles Are Merged
+    {GL_TRIANGLES, {0, 3}, {3, 3}, 2, {0}, {6}, 1},
+    // A Partial Triangle Ends Its Range
+    {GL_TRIANGLES, {0, 4}, {4, 3}, 2, {0, 4}, {4, 3}, 2},
+    {GL_LINES, {0, 3, 5}, {3, 2, 2}, 3, {0, 3}, {3, 4}, 2},
+    // Strips Are Never Merged
+    {GL_TRIANGLE_STRIP, {0, 4}, {4, 4}, 2, {0, 4}, {4, 4}, 2}
+};
+static void check_deferred_draws() {
+    for (size_t i = 0; i < sizeof (deferred_checks) / sizeof (deferred_checks[0]); i++) {
+        const deferred_check_t *check = &deferred_checks[i];
+        init_gles_compatibility_layer(get_null_driver_proc_address);
+        setup_buffer();
+        set_gles_compatibility_layer_deferred_draws(1);
+        glFinish();
+        null_driver_draws.size = 0;
+        for (GLsizei j = 0; j < check->size; j++) {
+            glDrawArrays(check->mode, check->first[j], check->count[j]);
+        }
+        glFinish();
+        int matches = null_driver_draws.size == check->submitted_size;
+        for (GLsizei j = 0; matches && j < check->submitted_size; j++) {
+            matches = null_driver_draws.first[j] == check->submitted_first[j] && null_driver_draws.count[j] == check->submitted_count[j];
+        }
+        if (!matches) {
+            ERR("Deferred Draw Check %i Submitted The Wrong Ranges", (int) i);
+        }
+    }
+}
+// Streamed Vertices And Indices Must Survive The Stream Buffer Being Orphaned
+#define STREAMED_VERTICES 60000
+#define STREAMED_INDICES 65535
+static void check_streamed_elements() {
+    init_gles_compatibility_layer(get_null_driver_proc_address);
+    static GLfloat vertices[STREAMED_VERTICES * 3];
+    static GLushort indices[STREAMED_INDICES];
+    for (int i = 0; i < STREAMED_INDICES; i++) {
+        indices[i] = i % STREAMED_VERTICES;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, vertices);
+    const uint64_t discarded = null_driver_discarded_uploads;
+    // Enough Draws To Fill The Stream Buffer Several Times
+    for (int i = 0; i < 32; i++) {
+        glDrawElements(GL_TRIANGLES, STREAMED_INDICES - (STREAMED_INDICES % 3), GL_UNSIGNED_SHORT, indices);
+    }
+    glFinish();
+    if (null_driver_discarded_uploads != discarded) {
+        ERR("Streamed Draw Data Was Orphaned Before Being Drawn");
+    }
+}
+
+// Main
+static void usage(const char *name) {
+    ERR("Usage: %s [--threaded] [--es3] [--quick] [--save <baseline>] [--compare <baseline>] [--tolerance <percent>]", name);
+}
+int main(int argc, char *argv[]) {
+    // Options
+    const char *save = NULL;
+    const char *compare = NULL;
+    double tolerance = 25;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threaded") == 0) {
+            threaded = 1;
+        } else if (strcmp(argv[i], "--es3") == 0) {
+            null_driver_es3 = 1;
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            min_time = 10000000;
+            repetitions = 1;
+        } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            save = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            compare = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    result_t baseline[BENCHMARKS_SIZE];
+    int has_baseline[BENCHMARKS_SIZE] = {0};
+    if (compare != NULL && !load_baseline(compare, baseline, has_baseline)) {
+        ERR("Unable To Read Baseline: %s", compare);
+    }
+
+    // Check
+    check_deferred_draws();
+    check_streamed_elements();
+
+    // Run
+    INFO("Running Benchmarks%s%s...", null_driver_es3 ? " (OpenGL ES 3.0)" : "", threaded ? " (Submission Thread)" : "");
+    printf("%-34s %10s %10s\n", "Benchmark", "ns/op", "calls/op");
+    result_t results[BENCHMARKS_SIZE];
+    int regressions = 0;
+    for (int i = 0; i < BENCHMARKS_SIZE; i++) {
+        results[i] = run(&benchmarks[i]);
+        printf("%-34s %10.2f %10.2f", benchmarks[i].name, results[i].ns_per_op, results[i].calls_per_op);
+        if (has_baseline[i]) {
+            // Call Counts Are Deterministic, Timings Get Some Slack
+            const double change = ((results[i].ns_per_op / baseline[i].ns_per_op) - 1) * 100;
+            const int slower = change > tolerance;
+            const int more_calls = results[i].calls_per_op > baseline[i].calls_per_op + 0.005;
+            printf(" %+8.1f%%%s%s", change, slower ? " SLOWER" : "", more_calls ? " MORE CALLS" : "");
+            regressions += slower || more_calls;
+        }
+        printf("\n");
+    }
+
+    // Baseline
+    if (save != NULL) {
+        save_baseline(save, results);
+        INFO("Saved Baseline: %s", save);
+    }
+    if (regressions > 0) {
+        ERR("%i Regression(s) Against %s", regressions, compare);
+    }
+}
@@ -0,0 +1,174 @@
+#include <string.h>
+
+#include "null_driver.h"
+
+// Counters
+null_driver_calls_t null_driver_calls;
+int null_driver_es3 = 0;
+null_driver_draws_t null_driver_draws;
+uint64_t null_driver_discarded_uploads = 0;
+uint64_t get_null_driver_total_calls() {
+    uint64_t total = 0;
+    const uint64_t *counters = (const uint64_t *) &null_driver_calls;
+    for (size_t i = 0; i < sizeof (null_driver_calls) / sizeof (uint64_t); i++) {
+        total += counters[i];
+    }
+    return total;
+}
+
+// Functions That Do Nothing
+#define NULL_DRIVER_IGNORE_ARG(type, name) (void) name;
+#define NULL_DRIVER_FUNCTION(name, return_type, args) \
+    static return_type GL_APIENTRY null_##name(GL_PARAMS(args)) { \
+        null_driver_calls.name++; \
+        GL_FOR_EACH(NULL_DRIVER_IGNORE_ARG, GL_NOTHING, GL_STRIP args) \
+        return (return_type) 0; \
+    }
+GL_DISPATCH_FUNCTIONS(NULL_DRIVER_FUNCTION, NULL_DRIVER_FUNCTION)
+
+// Functions Whose Results The Layer Depends On
+#define REAL_GL_COMPILE_STATUS 0x8b81
+#define REAL_GL_LINK_STATUS 0x8b82
+#define REAL_GL_EXTENSIONS 0x1f03
+#define REAL_GL_VERSION 0x1f02
+static GLuint next_name = 1;
+static void GL_APIENTRY generate_buffers(GLsizei n, GLuint *buffers) {
+    null_driver_calls.glGenBuffers++;
+    for (GLsizei i = 0; i < n; i++) {
+        buffers[i] = next_name++;
+    }
+}
+static void GL_APIENTRY generate_textures(GLsizei n, GLuint *textures) {
+    null_driver_calls.glGenTextures++;
+    for (GLsizei i = 0; i < n; i++) {
+        textures[i] = next_name++;
+    }
+}
+static void GL_APIENTRY generate_vertex_arrays(GLsizei n, GLuint *arrays) {
+    null_driver_calls.glGenVertexArrays++;
+    for (GLsizei i = 0; i < n; i++) {
+        arrays[i] = next_name++;
+    }
+}
+static void GL_APIENTRY generate_vertex_arrays_oes(GLsizei n, GLuint *arrays) {
+    null_driver_calls.glGenVertexArraysOES++;
+    for (GLsizei i = 0; i < n; i++) {
+        arrays[i] = next_name++;
+    }
+}
+// Targets Uploaded To Since The Last Draw (Orphaning The Bound Buffer Would Discard Those Uploads)
+#define UPLOAD_TARGETS 4
+static GLenum upload_targets[UPLOAD_TARGETS];
+static int upload_targets_size = 0;
+static void GL_APIENTRY buffer_data(GLenum target, __attribute__((unused)) GLsizeiptr size, const void *data, __attribute__((unused)) GLenum usage) {
+    null_driver_calls.glBufferData++;
+    for (int i = 0; data == NULL && i < upload_targets_size; i++) {
+        if (upload_targets[i] == target) {
+            null_driver_discarded_uploads++;
+        }
+    }
+}
+static void GL_APIENTRY buffer_sub_data(GLenum target, __attribute__((unused)) GLintptr offset, __attribute__((unused)) GLsizeiptr size, __attribute__((unused)) const void *data) {
+    null_driver_calls.glBufferSubData++;
+    for (int i = 0; i < upload_targets_size; i++) {
+        if (upload_targets[i] == target) {
+            return;
+        }
+    }
+    if (upload_targets_size < UPLOAD_TARGETS) {
+        upload_targets[upload_targets_size++] = target;
+    }
+}
+static void GL_APIENTRY draw_elements(__attribute__((unused)) GLenum mode, __attribute__((unused)) GLsizei count, __attribute__((unused)) GLenum type, __attribute__((unused)) const void *indices) {
+    null_driver_calls.glDrawElements++;
+    upload_targets_size = 0;
+}
+static void record_draw(const GLint first, const GLsizei count) {
+    upload_targets_size = 0;
+    if (null_driver_draws.size < NULL_DRIVER_MAX_DRAWS) {
+        null_driver_draws.first[null_driver_draws.size] = first;
+        null_driver_draws.count[null_driver_draws.size] = count;
+    }
+    null_driver_draws.size++;
+}
+static void GL_APIENTRY draw_arrays(__attribute__((unused)) GLenum mode, GLint first, GLsizei count) {
+    null_driver_calls.glDrawArrays++;
+    record_draw(first, count);
+}
+static void GL_APIENTRY multi_draw_arrays(__attribute__((unused)) GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount) {
+    null_driver_calls.glMultiDrawArraysEXT++;
+    for (GLsizei i = 0; i < drawcount; i++) {
+        record_draw(first[i], count[i]);
+    }
+}
+static GLuint GL_APIENTRY create_shader(__attribute__((unused)) GLenum type) {
+    null_driver_calls.glCreateShader++;
+    return next_name++;
+}
+static GLuint GL_APIENTRY create_program() {
+    null_driver_calls.glCreateProgram++;
+    return next_name++;
+}
+static void GL_APIENTRY get_shader(__attribute__((unused)) GLuint shader, GLenum pname, GLint *params) {
+    null_driver_calls.glGetShaderiv++;
+    *params = pname == REAL_GL_COMPILE_STATUS;
+}
+static void GL_APIENTRY get_program(__attribute__((unused)) GLuint program, GLenum pname, GLint *params) {
+    null_driver_calls.glGetProgramiv++;
+    *params = pname == REAL_GL_LINK_STATUS;
+}
+static void GL_APIENTRY get_integer(__attribute__((unused)) GLenum pname, GLint *data) {
+    null_driver_calls.glGetIntegerv++;
+    *data = 0;
+}
+static const unsigned char *GL_APIENTRY get_string(GLenum name) {
+    null_driver_calls.glGetString++;
+    // Allows Deferred Draws To Be Merged And Attribute Layouts To Be Cached
+    if (name == REAL_GL_EXTENSIONS) {
+        return (const unsigned char *) "GL_EXT_multi_draw_arrays GL_OES_vertex_array_object";
+    } else if (name == REAL_GL_VERSION) {
+        return (const unsigned char *) (null_driver_es3 ? "OpenGL ES 3.0 Null" : "OpenGL ES 2.0 Null");
+    } else {
+        return (const unsigned char *) "Null";
+    }
+}
+
+// Lookup
+typedef struct {
+    const char *name;
+    void *function;
+} null_driver_entry_t;
+static const null_driver_entry_t overrides[] = {
+    {"glGenBuffers", (void *) generate_buffers},
+    {"glGenTextures", (void *) generate_textures},
+    {"glGenVertexArrays", (void *) generate_vertex_arrays},
+    {"glGenVertexArraysOES", (void *) generate_vertex_arrays_oes},
+    {"glBufferData", (void *) buffer_data},
+    {"glBufferSubData", (void *) buffer_sub_data},
+    {"glDrawArrays", (void *) draw_arrays},
+    {"glDrawElements", (void *) draw_elements},
+    {"glMultiDrawArraysEXT", (void *) multi_draw_arrays},
+    {"glCreateShader", (void *) create_shader},
+    {"glCreateProgram", (void *) create_program},
+    {"glGetShaderiv", (void *) get_shader},
+    {"glGetProgramiv", (void *) get_program},
+    {"glGetIntegerv", (void *) get_integer},
+    {"glGetString", (void *) get_string}
+};
+#define NULL_DRIVER_ENTRY(name, return_type, args) {#name, (void *) null_##name},
+static const null_driver_entry_t functions[] = {
+    GL_DISPATCH_FUNCTIONS(NULL_DRIVER_ENTRY, NULL_DRIVER_ENTRY)
+};
+void *get_null_driver_proc_address(const char *name) {
+    for (size_t i = 0; i < sizeof (overrides) / sizeof (overrides[0]); i++) {
+        if (strcmp(overrides[i].name, name) == 0) {
+            return overrides[i].function;
+        }
+    }
+    for (size_t i = 0; i < sizeof (functions) / sizeof (functions[0]); i++) {
+        if (strcmp(functions[i].name, name) == 0) {
+            return functions[i].function;
+        }
+    }
+    return NULL;
+}
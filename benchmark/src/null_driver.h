@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "passthrough.h"
+
+// Null Driver
+// Every Real GL Function Does Nothing Except Count Its Calls, Queries Report Success
+#define NULL_DRIVER_COUNTER(name, return_type, args) uint64_t name;
+typedef struct {
+    GL_DISPATCH_FUNCTIONS(NULL_DRIVER_COUNTER, NULL_DRIVER_COUNTER)
+} null_driver_calls_t;
+// Only Written By The Thread Making Real GL Calls
+extern null_driver_calls_t null_driver_calls;
+uint64_t get_null_driver_total_calls();
+// Report OpenGL ES 3.0 (Set Before Creating A Context)
+extern int null_driver_es3;
+// Ranges Submitted By glDrawArrays And glMultiDrawArraysEXT (size Keeps Counting Past The Limit)
+#define NULL_DRIVER_MAX_DRAWS 64
+typedef struct {
+    GLint first[NULL_DRIVER_MAX_DRAWS];
+    GLsizei count[NULL_DRIVER_MAX_DRAWS];
+    GLsizei size;
+} null_driver_draws_t;
+extern null_driver_draws_t null_driver_draws;
+// Uploads Thrown Away By Orphaning A Buffer Before A Draw Read Them
+extern uint64_t null_driver_discarded_uploads;
+void *get_null_driver_proc_address(const char *name);
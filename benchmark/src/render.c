@@ -0,0 +1,495 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <GLES/gl.h>
+
+#define INFO(format, ...) \
+    { \
+        fprintf(stderr, "[INFO]: " format "\n", ##__VA_ARGS__); \
+    }
+#define ERR(format, ...) \
+    { \
+        fprintf(stderr, "[ERR]: (%s:%i): " format "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
+        exit(EXIT_FAILURE); \
+    }
+
+// Time
+static uint64_t get_time() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return ((uint64_t) time.tv_sec * 1000000000ull) + time.tv_nsec;
+}
+
+// Options
+static int width = 1280;
+static int height = 720;
+static int frames = 100;
+static int es3 = 0;
+static int deferred = 0;
+
+// Count The Draw Calls That Reach The Driver
+typedef void (*draw_arrays_t)(GLenum mode, GLint first, GLsizei count);
+typedef void (*draw_elements_t)(GLenum mode, GLsizei count, GLenum type, const void *indices);
+typedef void (*multi_draw_arrays_t)(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount);
+static draw_arrays_t real_draw_arrays;
+static draw_elements_t real_draw_elements;
+static multi_draw_arrays_t real_multi_draw_arrays;
+static long draw_calls = 0;
+static void count_draw_arrays(GLenum mode, GLint first, GLsizei count) {
+    draw_calls++;
+    real_draw_arrays(mode, first, count);
+}
+static void count_draw_elements(GLenum mode, GLsizei count, GLenum type, const void *indices) {
+    draw_calls++;
+    real_draw_elements(mode, count, type, indices);
+}
+static void count_multi_draw_arrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount) {
+    draw_calls++;
+    real_multi_draw_arrays(mode, first, count, drawcount);
+}
+static void *get_proc_address(const char *name) {
+    void *function = (void *) eglGetProcAddress(name);
+    if (function == NULL) {
+        return NULL;
+    } else if (strcmp(name, "glDrawArrays") == 0) {
+        real_draw_arrays = (draw_arrays_t) function;
+        return (void *) count_draw_arrays;
+    } else if (strcmp(name, "glDrawElements") == 0) {
+        real_draw_elements = (draw_elements_t) function;
+        return (void *) count_draw_elements;
+    } else if (strcmp(name, "glMultiDrawArraysEXT") == 0) {
+        real_multi_draw_arrays = (multi_draw_arrays_t) function;
+        return (void *) count_multi_draw_arrays;
+    }
+    return function;
+}
+
+// Create A Headless Context (Surfaceless If Mesa Supports It, Otherwise The Default Display)
+static void create_context() {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    const char *extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (extensions != NULL && strstr(extensions, "EGL_MESA_platform_surfaceless") != NULL) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (get_platform_display != NULL) {
+            display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        }
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+        ERR("Unable To Initialize EGL");
+    }
+
+    // Config
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, es3 ? EGL_OPENGL_ES3_BIT : EGL_OPENGL_ES2_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configs;
+    if (!eglChooseConfig(display, config_attributes, &config, 1, &configs) || configs < 1) {
+        ERR("Unable To Find EGL Config");
+    }
+
+    // Context
+    eglBindAPI(EGL_OPENGL_ES_API);
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_CLIENT_VERSION, es3 ? 3 : 2,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+    if (context == EGL_NO_CONTEXT) {
+        ERR("Unable To Create OpenGL ES %i Context", es3 ? 3 : 2);
+    }
+
+    // Surface
+    const EGLint surface_attributes[] = {
+        EGL_WIDTH, width,
+        EGL_HEIGHT, height,
+        EGL_NONE
+    };
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surface_attributes);
+    if (surface == EGL_NO_SURFACE || !eglMakeCurrent(display, surface, surface, context)) {
+        ERR("Unable To Create Pbuffer");
+    }
+}
+
+// Deterministic Random Numbers
+static unsigned int seed;
+static float random_float() {
+    seed = (seed * 1103515245u) + 12345u;
+    return (float) ((seed >> 8) & 0xffff) / 65535.0f;
+}
+
+// Textures
+static GLuint create_texture(const int size, const int pattern) {
+    unsigned char *pixels = malloc(size * size * 4);
+    if (pixels == NULL) {
+        ERR("Memory Allocation Failed");
+    }
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            unsigned char *pixel = &pixels[((y * size) + x) * 4];
+            const float u = ((float) x / size) - 0.5f;
+            const float v = ((float) y / size) - 0.5f;
+            if (pattern == 0) {
+                // Checkerboard
+                const int checker = ((x / 4) + (y / 4)) & 1;
+                pixel[0] = checker ? 255 : 64;
+                pixel[1] = checker ? 192 : 32;
+                pixel[2] = 128;
+                pixel[3] = 255;
+            } else if (pattern == 1) {
+                // Grass
+                pixel[0] = 40 + (rand() % 30);
+                pixel[1] = 120 + (rand() % 60);
+                pixel[2] = 30 + (rand() % 20);
+                pixel[3] = 255;
+            } else {
+                // Leaves (Ragged Disc, Roughly Half Transparent)
+                const float distance = sqrtf((u * u) + (v * v)) + (0.1f * sinf(atan2f(v, u) * 9));
+                pixel[0] = 30;
+                pixel[1] = 100 + (rand() % 100);
+                pixel[2] = 20;
+                pixel[3] = distance < 0.4f && (rand() % 4) != 0 ? 255 : 0;
+            }
+        }
+    }
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    free(pixels);
+    return texture;
+}
+
+// Perspective Projection (There Is No glFrustumf)
+static void perspective(const float fov, const float near, const float far) {
+    const float f = 1.0f / tanf(fov * (float) M_PI / 360.0f);
+    const float aspect = (float) width / height;
+    const GLfloat matrix[16] = {
+        f / aspect, 0, 0, 0,
+        0, f, 0, 0,
+        0, 0, (far + near) / (near - far), -1,
+        0, 0, (2 * far * near) / (near - far), 0
+    };
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glMultMatrixf(matrix);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+}
+
+// Sprites: Many Small Textured Draws With Blending
+#define SPRITES 4000
+#define SPRITE_TEXTURES 4
+static GLuint sprite_textures[SPRITE_TEXTURES];
+static float sprite_positions[SPRITES][3];
+static void setup_sprites() {
+    for (int i = 0; i < SPRITE_TEXTURES; i++) {
+        sprite_textures[i] = create_texture(32, 0);
+    }
+    for (int i = 0; i < SPRITES; i++) {
+        sprite_positions[i][0] = random_float() * width;
+        sprite_positions[i][1] = random_float() * height;
+        sprite_positions[i][2] = random_float() * 360;
+    }
+    static const GLfloat quad[] = {
+        -8, -8, 0, 0,
+        8, -8, 1, 0,
+        -8, 8, 0, 1,
+        8, 8, 1, 1
+    };
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof (quad), quad, GL_STATIC_DRAW);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 4 * sizeof (GLfloat), NULL);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, 4 * sizeof (GLfloat), (void *) (2 * sizeof (GLfloat)));
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrthof(0, width, height, 0, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+static void draw_sprites(const int frame) {
+    glClear(GL_COLOR_BUFFER_BIT);
+    for (int i = 0; i < SPRITES; i++) {
+        // Sorted By Texture, As A 2D Renderer Would
+        glBindTexture(GL_TEXTURE_2D, sprite_textures[(i * SPRITE_TEXTURES) / SPRITES]);
+        glPushMatrix();
+        glTranslatef(sprite_positions[i][0], sprite_positions[i][1], 0);
+        glRotatef(sprite_positions[i][2] + frame, 0, 0, 1);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glPopMatrix();
+    }
+}
+
+// Terrain: A Large Fogged And Textured Mesh
+#define TERRAIN_SIZE 128
+#define TERRAIN_TILES 3
+#define TERRAIN_INDICES ((TERRAIN_SIZE - 1) * (TERRAIN_SIZE - 1) * 6)
+static GLuint terrain_texture;
+static void setup_terrain() {
+    terrain_texture = create_texture(64, 1);
+
+    // Vertices (Position, Texture Coordinates, Color)
+    typedef struct {
+        GLfloat position[3];
+        GLfloat tex_coord[2];
+        GLubyte color[4];
+    } vertex_t;
+    vertex_t *vertices = malloc(TERRAIN_SIZE * TERRAIN_SIZE * sizeof (vertex_t));
+    GLushort *indices = malloc(TERRAIN_INDICES * sizeof (GLushort));
+    if (vertices == NULL || indices == NULL) {
+        ERR("Memory Allocation Failed");
+    }
+    for (int z = 0; z < TERRAIN_SIZE; z++) {
+        for (int x = 0; x < TERRAIN_SIZE; x++) {
+            vertex_t *vertex = &vertices[(z * TERRAIN_SIZE) + x];
+            const float y = (sinf(x * 0.15f) * cosf(z * 0.1f) * 4) + (sinf((x + z) * 0.05f) * 6);
+            vertex->position[0] = x;
+            vertex->position[1] = y;
+            vertex->position[2] = z;
+            vertex->tex_coord[0] = x * 0.25f;
+            vertex->tex_coord[1] = z * 0.25f;
+            const unsigned char shade = (unsigned char) (160 + (y * 8));
+            vertex->color[0] = shade;
+            vertex->color[1] = shade;
+            vertex->color[2] = shade;
+            vertex->color[3] = 255;
+        }
+    }
+    int index = 0;
+    for (int z = 0; z < TERRAIN_SIZE - 1; z++) {
+        for (int x = 0; x < TERRAIN_SIZE - 1; x++) {
+            const GLushort corner = (z * TERRAIN_SIZE) + x;
+            indices[index++] = corner;
+            indices[index++] = corner + TERRAIN_SIZE;
+            indices[index++] = corner + 1;
+            indices[index++] = corner + 1;
+            indices[index++] = corner + TERRAIN_SIZE;
+            indices[index++] = corner + TERRAIN_SIZE + 1;
+        }
+    }
+    GLuint buffers[2];
+    glGenBuffers(2, buffers);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, TERRAIN_SIZE * TERRAIN_SIZE * sizeof (vertex_t), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, TERRAIN_INDICES * sizeof (GLushort), indices, GL_STATIC_DRAW);
+    free(vertices);
+    free(indices);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof (vertex_t), (void *) 0);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, sizeof (vertex_t), (void *) (3 * sizeof (GLfloat)));
+    glEnableClientState(GL_COLOR_ARRAY);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof (vertex_t), (void *) (5 * sizeof (GLfloat)));
+
+    // State
+    perspective(70, 0.5f, 400);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, terrain_texture);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glEnable(GL_FOG);
+    glFogx(GL_FOG_MODE, GL_LINEAR);
+    glFogf(GL_FOG_START, 40);
+    glFogf(GL_FOG_END, 250);
+    static const GLfloat fog_color[] = {0.6f, 0.7f, 0.9f, 1};
+    glFogfv(GL_FOG_COLOR, fog_color);
+    glClearColor(fog_color[0], fog_color[1], fog_color[2], fog_color[3]);
+}
+static void draw_terrain(const int frame) {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glLoadIdentity();
+    glRotatef(15, 1, 0, 0);
+    glRotatef(frame * 0.5f, 0, 1, 0);
+    glTranslatef(0, -20, 0);
+    for (int z = 0; z < TERRAIN_TILES; z++) {
+        for (int x = 0; x < TERRAIN_TILES; x++) {
+            glPushMatrix();
+            glTranslatef((x - (TERRAIN_TILES / 2.0f)) * (TERRAIN_SIZE - 1), 0, (z - (TERRAIN_TILES / 2.0f)) * (TERRAIN_SIZE - 1));
+            glDrawElements(GL_TRIANGLES, TERRAIN_INDICES, GL_UNSIGNED_SHORT, NULL);
+            glPopMatrix();
+        }
+    }
+}
+
+// Foliage: Overlapping Alpha-Tested Billboards
+#define FOLIAGE 3000
+#define FOLIAGE_BATCH 50
+static GLuint foliage_texture;
+static void setup_foliage() {
+    foliage_texture = create_texture(64, 2);
+    GLfloat *vertices = malloc(FOLIAGE * 6 * 5 * sizeof (GLfloat));
+    if (vertices == NULL) {
+        ERR("Memory Allocation Failed");
+    }
+    GLfloat *vertex = vertices;
+    for (int i = 0; i < FOLIAGE; i++) {
+        const float x = (random_float() - 0.5f) * 60;
+        const float y = (random_float() - 0.5f) * 20;
+        const float z = -5 - (random_float() * 60);
+        const float size = 1 + (random_float() * 3);
+        static const float corners[6][2] = {{0, 0}, {1, 0}, {0, 1}, {1, 0}, {1, 1}, {0, 1}};
+        for (int j = 0; j < 6; j++) {
+            *vertex++ = x + ((corners[j][0] - 0.5f) * size);
+            *vertex++ = y + ((corners[j][1] - 0.5f) * size);
+            *vertex++ = z;
+            *vertex++ = corners[j][0];
+            *vertex++ = corners[j][1];
+        }
+    }
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, FOLIAGE * 6 * 5 * sizeof (GLfloat), vertices, GL_STATIC_DRAW);
+    free(vertices);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 5 * sizeof (GLfloat), (void *) 0);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, 5 * sizeof (GLfloat), (void *) (3 * sizeof (GLfloat)));
+
+    // State
+    perspective(60, 1, 100);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, foliage_texture);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_ALPHA_TEST);
+    glAlphaFunc(GL_GREATER, 0.5f);
+    glClearColor(0.2f, 0.3f, 0.2f, 1);
+}
+static void draw_foliage(const int frame) {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glLoadIdentity();
+    glTranslatef(sinf(frame * 0.05f) * 5, 0, 0);
+    for (int i = 0; i < FOLIAGE; i += FOLIAGE_BATCH) {
+        // Slight Tint Per Batch
+        const float tint = 0.8f + (0.2f * (float) i / FOLIAGE);
+        glColor4f(tint, 1, tint, 1);
+        glDrawArrays(GL_TRIANGLES, i * 6, FOLIAGE_BATCH * 6);
+    }
+}
+
+// Scenes
+typedef struct {
+    const char *name;
+    void (*setup)();
+    void (*draw)(int frame);
+} scene_t;
+static const scene_t scenes[] = {
+    {"Sprites", setup_sprites, draw_sprites},
+    {"Fogged Terrain", setup_terrain, draw_terrain},
+    {"Alpha-Tested Foliage", setup_foliage, draw_foliage}
+};
+#define SCENES_SIZE ((int) (sizeof (scenes) / sizeof (scenes[0])))
+static int compare_frames(const void *a, const void *b) {
+    const double x = *(const double *) a;
+    const double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+static void run(const scene_t *scene) {
+    // Fresh Layer Context
+    init_gles_compatibility_layer(get_proc_address);
+    set_gles_compatibility_layer_deferred_draws(deferred);
+    glViewport(0, 0, width, height);
+    seed = 1;
+    srand(1);
+    scene->setup();
+
+    // Warm Up (Compiles Shaders)
+    for (int i = 0; i < 5; i++) {
+        scene->draw(i);
+    }
+    glFinish();
+
+    // Measure (glFinish Waits For llvmpipe To Finish Each Frame)
+    double *times = malloc(frames * sizeof (double));
+    if (times == NULL) {
+        ERR("Memory Allocation Failed");
+    }
+    const long start_draw_calls = draw_calls;
+    const uint64_t start = get_time();
+    uint64_t frame_start = start;
+    for (int i = 0; i < frames; i++) {
+        scene->draw(i);
+        glFinish();
+        const uint64_t time = get_time();
+        times[i] = (double) (time - frame_start) / 1000000.0;
+        frame_start = time;
+    }
+    const double total = (double) (get_time() - start) / 1000000000.0;
+    const GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        ERR("%s Produced GL Error: 0x%x", scene->name, error);
+    }
+    qsort(times, frames, sizeof (double), compare_frames);
+    printf("%-24s %10.1f %10.3f %10.3f %12.1f\n", scene->name, frames / total, times[frames / 2], times[(frames * 95) / 100], (double) (draw_calls - start_draw_calls) / frames);
+    free(times);
+}
+
+// Main
+int main(int argc, char *argv[]) {
+    // Options
+    const char *only = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--es3") == 0) {
+            es3 = 1;
+        } else if (strcmp(argv[i], "--deferred") == 0) {
+            deferred = 1;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc && sscanf(argv[i + 1], "%ix%i", &width, &height) == 2) {
+            i++;
+        } else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else {
+            ERR("Usage: %s [--es3] [--deferred] [--frames <count>] [--size <width>x<height>] [--scene <name>]", argv[0]);
+        }
+    }
+    if (frames < 1 || width < 1 || height < 1) {
+        ERR("Invalid Options");
+    }
+
+    // Setup
+    create_context();
+    INFO("Rendering %i Frames At %ix%i (OpenGL ES %i%s)...", frames, width, height, es3 ? 3 : 2, deferred ? ", Deferred Draws" : "");
+
+    // Run
+    printf("%-24s %10s %10s %10s %12s\n", "Scene", "FPS", "Median ms", "95th ms", "Draws/Frame");
+    int ran = 0;
+    for (int i = 0; i < SCENES_SIZE; i++) {
+        if (only == NULL || strcmp(only, scenes[i].name) == 0) {
+            run(&scenes[i]);
+            ran++;
+        }
+    }
+    if (ran == 0) {
+        ERR("Unknown Scene: %s", only);
+    }
+}
@@ -10,6 +10,8 @@ extern "C" {
 #define GL_FALSE 0
 #define GL_ARRAY_BUFFER_BINDING 0x8894
 #define GL_ARRAY_BUFFER 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_ELEMENT_ARRAY_BUFFER_BINDING 0x8895
 #define GL_TEXTURE_BINDING_2D 0x8069
 #define GL_UNSIGNED_BYTE 0x1401
 #define GL_FLOAT 0x1406
@@ -82,14 +84,27 @@ extern "C" {
 #define GL_COLOR_BUFFER_BIT 0x4000
 #define GL_NO_ERROR 0
 #define GL_BYTE 0x1400
+#define GL_SHORT 0x1402
+#define GL_FIXED 0x140c
 #define GL_ACCUM 0x100
 #define GL_ALPHA 0x1906
 #define GL_NONE 0
 #define GL_ALIASED_LINE_WIDTH_RANGE 0x846e
+#define GL_POINTS 0x0
+#define GL_LINE_LOOP 0x2
+#define GL_QUADS 0x7
+#define GL_QUAD_STRIP 0x8
+#define GL_POLYGON 0x9
+#define GL_UNSIGNED_SHORT 0x1403
+#define GL_UNSIGNED_INT 0x1405
+#define GL_COMPILE 0x1300
+#define GL_COMPILE_AND_EXECUTE 0x1301
 
 typedef float GLfloat;
 typedef float GLclampf;
 typedef int GLint;
+typedef unsigned char GLubyte;
+typedef unsigned short GLushort;
 typedef unsigned char GLboolean;
 typedef int GLsizei;
 typedef unsigned int GLuint;
@@ -106,6 +121,7 @@ void glVertexPointer(GLint size, GLenum type, GLsizei stride, const void *pointe
 void glLineWidth(GLfloat width);
 void glBlendFunc(GLenum sfactor, GLenum dfactor);
 void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices);
 void glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
 void glClear(GLbitfield mask);
 void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage);
@@ -157,10 +173,101 @@ GLenum glGetError();
 void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
 void glPixelStorei(GLenum pname, GLint param);
 void glMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount);
+void glFlush();
+void glFinish();
+
+// Immediate Mode (Layer Extension)
+// Consecutive Blocks Are Merged When Deferred Draws Are Enabled
+void glBegin(GLenum mode);
+void glEnd();
+void glVertex2f(GLfloat x, GLfloat y);
+void glVertex3f(GLfloat x, GLfloat y, GLfloat z);
+void glTexCoord2f(GLfloat s, GLfloat t);
+
+// Display Lists (Layer Extension)
+// Only Model View Matrix Operations, glColor4f And Draws From Client-Side Arrays Are Recorded, Other Calls Execute Immediately
+GLuint glGenLists(GLsizei range);
+void glDeleteLists(GLuint list, GLsizei range);
+void glNewList(GLuint list, GLenum mode);
+void glEndList();
+void glCallList(GLuint list);
+void glCallLists(GLsizei n, GLenum type, const GLvoid *lists);
 
 // Init
 typedef void *(*getProcAddress_t)(const char *);
+// Creates A Context (Destroying The One Made By The Previous Call) And Makes It Current
 void init_gles_compatibility_layer(getProcAddress_t);
+// Contexts
+// Each Context Has Its Own Emulated State, Shader Programs And Function Table, And Is Current On At Most One Thread At A Time
+// Element Array Buffer Data And Display Lists Are Shared With share_context (NULL For None), Like The Real Contexts Must Be
+// Creating Requires The Real Context To Be Current, The New Context Is Made Current On The Calling Thread
+typedef struct gles_compatibility_layer_context gles_compatibility_layer_context_t;
+gles_compatibility_layer_context_t *create_gles_compatibility_layer_context(getProcAddress_t get_proc_address, gles_compatibility_layer_context_t *share_context);
+// Must Be Called Whenever The Real Context Current On This Thread Changes (NULL Releases The Current Context)
+void make_gles_compatibility_layer_context_current(gles_compatibility_layer_context_t *context);
+gles_compatibility_layer_context_t *get_current_gles_compatibility_layer_context();
+// GL Objects Are Left To Be Destroyed With The Real Context
+void destroy_gles_compatibility_layer_context(gles_compatibility_layer_context_t *context);
+// Must Be Called After Modifying GL State Without Going Through The Layer
+void invalidate_gles_compatibility_layer_state();
+// Merge Compatible Consecutive Draws, Including glBegin/glEnd Blocks (glFlush Must Be Called Before Swapping Buffers)
+void set_gles_compatibility_layer_deferred_draws(GLboolean enabled);
+// Texture Upload Statistics
+// glTexSubImage2D Updates Are Staged And Merged, Then Uploaded When The Texture Is Next Drawn With Or On glFlush
+typedef struct {
+    uint64_t staged_calls;
+    uint64_t uploads;
+    uint64_t bytes_staged;
+    uint64_t bytes_uploaded;
+    uint64_t bytes_saved;
+} gles_compatibility_layer_texture_stats_t;
+void get_gles_compatibility_layer_texture_stats(gles_compatibility_layer_texture_stats_t *stats);
+void reset_gles_compatibility_layer_texture_stats();
+// Program Binary Cache (Uses GL_OES_get_program_binary When Available)
+// Linked Shader Programs Are Stored In The Given Existing Directory, NULL Disables The Cache (Default)
+// Must Be Called Before Creating A Context To Affect Its Default Program
+void set_gles_compatibility_layer_program_cache(const char *directory);
+// Instrumentation (Only Recorded When Built With The GLES_COMPATIBILITY_LAYER_INSTRUMENTATION CMake Option)
+// Every Public Function And Every Driver Call Is Counted And Timed (Wall Time On The Calling Thread)
+#define GLES_COMPATIBILITY_LAYER_ENTRY_POINT 0
+#define GLES_COMPATIBILITY_LAYER_DRIVER_CALL 1
+#define GLES_COMPATIBILITY_LAYER_INTERNAL 2
+// Driver Calls Encoded For The Submission Thread (Timed Separately From Their Execution)
+#define GLES_COMPATIBILITY_LAYER_QUEUED_CALL 3
+#define GLES_COMPATIBILITY_LAYER_HISTOGRAM_BUCKETS 32
+typedef struct {
+    const char *name;
+    int category;
+    uint64_t calls;
+    uint64_t total_ns;
+    // Bucket i Counts Calls That Took Less Than 2^(i + 1) ns (The Last Bucket Counts Everything Longer)
+    uint64_t histogram[GLES_COMPATIBILITY_LAYER_HISTOGRAM_BUCKETS];
+} gles_compatibility_layer_call_stats_t;
+// Writes Up To max_stats Entries (Summed Over All Threads) And Returns How Many Exist
+int get_gles_compatibility_layer_call_stats(gles_compatibility_layer_call_stats_t *stats, int max_stats);
+void reset_gles_compatibility_layer_call_stats();
+// Records Every Call Until Stopped, Then Writes A Chrome Trace Event JSON File (Returns Whether It Was Written)
+void start_gles_compatibility_layer_trace();
+GLboolean stop_gles_compatibility_layer_trace(const char *path);
+// Capture (Only Recorded When Built With The GLES_COMPATIBILITY_LAYER_CAPTURE CMake Option)
+// Every Public Call Made Through The Current Context Is Appended To The File, Including The Buffer, Texture And Client Array Data It Reads
+// Objects Created Before Capturing Starts Are Not Recorded, So Start Right After Creating The Context (Returns Whether The File Was Opened)
+GLboolean start_gles_compatibility_layer_capture(const char *path);
+void stop_gles_compatibility_layer_capture();
+// Ends A Frame (Call Before Swapping Buffers)
+void mark_gles_compatibility_layer_capture_frame();
+// Re-Issues A Capture Through The Current Context As Fast As Possible, Calling callback At The End Of Every Frame
+// Returns The Number Of Frames, Or -1 If The File Is Not A Capture
+typedef void (*gles_compatibility_layer_frame_callback_t)(void *data);
+int replay_gles_compatibility_layer_capture(const char *path, gles_compatibility_layer_frame_callback_t callback, void *data);
+// Submission Thread (Real GL Calls Are Executed On A Dedicated Thread)
+// The Context Must Be Released Before Starting, The Callback Makes It Current (Or Releases It) On The New Thread
+// The Thread Serves The Current Layer Context, Which Must Stay Current On The Calling Thread Until It Is Stopped
+typedef void (*gles_compatibility_layer_thread_callback_t)(void *data, GLboolean current);
+void start_gles_compatibility_layer_thread(gles_compatibility_layer_thread_callback_t callback, void *data);
+void stop_gles_compatibility_layer_thread();
+// Runs A Function On The GL Thread After Every Previous Call (Use For Swapping Buffers)
+void queue_gles_compatibility_layer_callback(void (*func)(void *), void *data);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,488 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "passthrough.h"
+#include "context.h"
+#include "draw.h"
+#include "elements.h"
+#include "texture.h"
+#include "log.h"
+
+#ifdef GLES_COMPATIBILITY_LAYER_CAPTURE
+// State
+typedef struct {
+    uint64_t hash;
+    size_t size;
+    uint32_t index;
+} payload_entry_t;
+struct capture_state {
+    FILE *file;
+    // Record Being Built
+    uint32_t type;
+    unsigned char *record;
+    size_t record_size;
+    size_t record_capacity;
+    // Payloads Already Written (Open Addressing, Empty Entries Have A Size Of 0)
+    payload_entry_t *payloads;
+    uint32_t payloads_size;
+    uint32_t payloads_capacity;
+};
+#define capture (current_context->capture)
+
+// Nesting
+static __thread int capture_depth = 0;
+int begin_capture_scope() {
+    return capture_depth++ == 0 && current_context != NULL && capture != NULL;
+}
+void end_capture_scope(__attribute__((unused)) const int *scope) {
+    capture_depth--;
+}
+
+// Writing
+static void write_record(const uint32_t type, const void *data, const size_t size) {
+    static const unsigned char padding[4] = {0};
+    const capture_record_t record = {
+        .type = type,
+        .size = size
+    };
+    fwrite(&record, sizeof (record), 1, capture->file);
+    fwrite(data, 1, size, capture->file);
+    fwrite(padding, 1, CAPTURE_ALIGN(size) - size, capture->file);
+}
+static void begin_record(const uint32_t type) {
+    capture->type = type;
+    capture->record_size = 0;
+}
+static void capture_data(const void *data, const size_t size) {
+    if (capture->record_size + size > capture->record_capacity) {
+        capture->record_capacity = (capture->record_size + size) * 2;
+        capture->record = realloc(capture->record, capture->record_capacity);
+        ALLOC_CHECK(capture->record);
+    }
+    memcpy(capture->record + capture->record_size, data, size);
+    capture->record_size += size;
+}
+static void end_record() {
+    write_record(capture->type, capture->record, capture->record_size);
+}
+
+// Arguments
+static void capture_uint(const uint32_t value) {
+    capture_data(&value, sizeof (value));
+}
+static void capture_float(const GLfloat value) {
+    capture_data(&value, sizeof (value));
+}
+static void capture_int64(const int64_t value) {
+    capture_data(&value, sizeof (value));
+}
+#define CAPTURE_ARG(type, name) _Generic((type) 0, GLfloat: capture_float, default: capture_uint)(name);
+
+// Payloads
+// Identified By Their Hash And Size, So Unchanged Data Is Only Written Once
+static uint64_t rotate(const uint64_t x, const int bits) {
+    return (x << bits) | (x >> (64 - bits));
+}
+static uint64_t hash_payload(const void *data, const size_t size) {
+    // Eight Bytes At A Time (Payloads Are Often Whole Textures)
+    const unsigned char *bytes = data;
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ size;
+    size_t i = 0;
+    for (; i + sizeof (uint64_t) <= size; i += sizeof (uint64_t)) {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof (word));
+        hash ^= rotate(word * 0x87c37b91114253d5ull, 31) * 0x4cf5ad432745937full;
+        hash = (rotate(hash, 27) * 5) + 0x52dce729;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, bytes + i, size - i);
+    hash ^= rotate(tail * 0x87c37b91114253d5ull, 31) * 0x4cf5ad432745937full;
+    // Finalize
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+static payload_entry_t *find_payload(payload_entry_t *payloads, const uint32_t capacity, const uint64_t hash, const size_t size) {
+    uint32_t i = hash & (capacity - 1);
+    while (payloads[i].size != 0 && (payloads[i].hash != hash || payloads[i].size != size)) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &payloads[i];
+}
+static void grow_payloads() {
+    const uint32_t capacity = capture->payloads_capacity > 0 ? capture->payloads_capacity * 2 : 1024;
+    payload_entry_t *payloads = calloc(capacity, sizeof (payload_entry_t));
+    ALLOC_CHECK(payloads);
+    for (uint32_t i = 0; i < capture->payloads_capacity; i++) {
+        const payload_entry_t *entry = &capture->payloads[i];
+        if (entry->size != 0) {
+            *find_payload(payloads, capacity, entry->hash, entry->size) = *entry;
+        }
+    }
+    free(capture->payloads);
+    capture->payloads = payloads;
+    capture->payloads_capacity = capacity;
+}
+static uint32_t capture_payload(const void *data, const size_t size) {
+    if (data == NULL) {
+        return CAPTURE_NO_PAYLOAD;
+    }
+    if (size > UINT32_MAX) {
+        ERR("Capture Payload Too Large: %zu", size);
+    }
+    // Keep The Table At Most Half Full
+    if ((capture->payloads_size + 1) * 2 > capture->payloads_capacity) {
+        grow_payloads();
+    }
+    // Empty Payloads Still Need A Non-Zero Key
+    const size_t key_size = size + 1;
+    const uint64_t hash = hash_payload(data, size);
+    payload_entry_t *entry = find_payload(capture->payloads, capture->payloads_capacity, hash, key_size);
+    if (entry->size == 0) {
+        entry->hash = hash;
+        entry->size = key_size;
+        entry->index = capture->payloads_size++;
+        write_record(CAPTURE_PAYLOAD, data, size);
+    }
+    return entry->index;
+}
+
+// Start/Stop
+GLboolean start_gles_compatibility_layer_capture(const char *path) {
+    stop_gles_compatibility_layer_capture();
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return 0;
+    }
+    setvbuf(file, NULL, _IOFBF, 1024 * 1024);
+    capture_header_t header = {
+        .version = CAPTURE_VERSION
+    };
+    memcpy(header.magic, CAPTURE_MAGIC, sizeof (header.magic));
+    fwrite(&header, sizeof (header), 1, file);
+    capture = calloc(1, sizeof (capture_t));
+    ALLOC_CHECK(capture);
+    capture->file = file;
+    return 1;
+}
+void stop_gles_compatibility_layer_capture() {
+    if (capture == NULL) {
+        return;
+    }
+    if (ferror(capture->file) | fclose(capture->file)) {
+        DEBUG("Unable To Write Capture");
+    }
+    free(capture->record);
+    free(capture->payloads);
+    free(capture);
+    capture = NULL;
+}
+void _free_gles_compatibility_layer_capture() {
+    stop_gles_compatibility_layer_capture();
+}
+void mark_gles_compatibility_layer_capture_frame() {
+    if (capture != NULL) {
+        begin_record(CAPTURE_FRAME);
+        end_record();
+        // Complete Frames Survive A Crash
+        fflush(capture->file);
+    }
+}
+
+// Generated Functions
+#define CAPTURE_FUNCTION(name, args) \
+    void capture_##name(GL_PARAMS(args)) { \
+        begin_record(CAPTURE_##name); \
+        GL_FOR_EACH(CAPTURE_ARG, GL_NOTHING, GL_STRIP args) \
+        end_record(); \
+    }
+CAPTURE_FUNCTIONS(CAPTURE_FUNCTION, CAPTURE_IGNORE)
+
+// Object Names
+static void capture_names(const uint32_t type, const GLsizei n, const GLuint *names) {
+    begin_record(type);
+    capture_uint(n);
+    capture_data(names, n * sizeof (GLuint));
+    end_record();
+}
+void capture_glGenTextures(const GLsizei n, const GLuint *textures) {
+    capture_names(CAPTURE_glGenTextures, n, textures);
+}
+void capture_glDeleteTextures(const GLsizei n, const GLuint *textures) {
+    capture_names(CAPTURE_glDeleteTextures, n, textures);
+}
+void capture_glGenBuffers(const GLsizei n, const GLuint *buffers) {
+    capture_names(CAPTURE_glGenBuffers, n, buffers);
+}
+void capture_glDeleteBuffers(const GLsizei n, const GLuint *buffers) {
+    capture_names(CAPTURE_glDeleteBuffers, n, buffers);
+}
+static void capture_binding(const uint32_t type, const GLenum target, const GLuint name) {
+    begin_record(type);
+    capture_uint(target);
+    capture_uint(name);
+    end_record();
+}
+void capture_glBindTexture(const GLenum target, const GLuint texture) {
+    capture_binding(CAPTURE_glBindTexture, target, texture);
+}
+void capture_glBindBuffer(const GLenum target, const GLuint buffer) {
+    capture_binding(CAPTURE_glBindBuffer, target, buffer);
+}
+
+// Buffers
+void capture_glBufferData(const GLenum target, const GLsizeiptr size, const void *data, const GLenum usage) {
+    const uint32_t payload = capture_payload(data, size);
+    begin_record(CAPTURE_glBufferData);
+    capture_uint(target);
+    capture_int64(size);
+    capture_uint(payload);
+    capture_uint(usage);
+    end_record();
+}
+void capture_glBufferSubData(const GLenum target, const GLintptr offset, const GLsizeiptr size, const void *data) {
+    const uint32_t payload = capture_payload(data, size);
+    begin_record(CAPTURE_glBufferSubData);
+    capture_uint(target);
+    capture_int64(offset);
+    capture_int64(size);
+    capture_uint(payload);
+    end_record();
+}
+
+// Textures
+// Pixels In Formats The Layer Does Not Know Are Recorded Without A Payload
+static uint32_t capture_image(const void *pixels, const GLsizei width, const GLsizei height, const GLenum format, const GLenum type) {
+    const size_t size = get_image_size(width, height, format, type);
+    return size == UNKNOWN_IMAGE_SIZE ? CAPTURE_NO_PAYLOAD : capture_payload(pixels, size);
+}
+void capture_glTexImage2D(const GLenum target, const GLint level, const GLint internalformat, const GLsizei width, const GLsizei height, const GLint border, const GLenum format, const GLenum type, const void *pixels) {
+    const uint32_t payload = capture_image(pixels, width, height, format, type);
+    begin_record(CAPTURE_glTexImage2D);
+    capture_uint(target);
+    capture_uint(level);
+    capture_uint(internalformat);
+    capture_uint(width);
+    capture_uint(height);
+    capture_uint(border);
+    capture_uint(format);
+    capture_uint(type);
+    capture_uint(payload);
+    end_record();
+}
+void capture_glTexSubImage2D(const GLenum target, const GLint level, const GLint xoffset, const GLint yoffset, const GLsizei width, const GLsizei height, const GLenum format, const GLenum type, const void *pixels) {
+    const uint32_t payload = capture_image(pixels, width, height, format, type);
+    begin_record(CAPTURE_glTexSubImage2D);
+    capture_uint(target);
+    capture_uint(level);
+    capture_uint(xoffset);
+    capture_uint(yoffset);
+    capture_uint(width);
+    capture_uint(height);
+    capture_uint(format);
+    capture_uint(type);
+    capture_uint(payload);
+    end_record();
+}
+
+// Queries (Replayed Into Scratch Memory)
+void capture_glGetIntegerv(const GLenum pname) {
+    begin_record(CAPTURE_glGetIntegerv);
+    capture_uint(pname);
+    end_record();
+}
+void capture_glGetFloatv(const GLenum pname) {
+    begin_record(CAPTURE_glGetFloatv);
+    capture_uint(pname);
+    end_record();
+}
+void capture_glReadPixels(const GLint x, const GLint y, const GLsizei width, const GLsizei height, const GLenum format, const GLenum type) {
+    begin_record(CAPTURE_glReadPixels);
+    capture_uint(x);
+    capture_uint(y);
+    capture_uint(width);
+    capture_uint(height);
+    capture_uint(format);
+    capture_uint(type);
+    end_record();
+}
+
+// State
+void capture_glFogfv(const GLenum pname, const GLfloat *params) {
+    begin_record(CAPTURE_glFogfv);
+    capture_uint(pname);
+    capture_data(params, (pname == GL_FOG_COLOR ? 4 : 1) * sizeof (GLfloat));
+    end_record();
+}
+void capture_glMultMatrixf(const GLfloat *m) {
+    begin_record(CAPTURE_glMultMatrixf);
+    capture_data(m, 16 * sizeof (GLfloat));
+    end_record();
+}
+
+// Array Pointers
+// Client-Side Pointers Are Meaningless In Another Process, Their Data Is Captured By Each Draw Instead
+static void capture_array_pointer(const uint32_t type, const GLint size, const GLenum data_type, const GLsizei stride, const void *pointer) {
+    GLint buffer;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &buffer);
+    begin_record(type);
+    capture_uint(size);
+    capture_uint(data_type);
+    capture_uint(stride);
+    capture_int64(buffer != 0 ? (int64_t) (intptr_t) pointer : 0);
+    end_record();
+}
+void capture_glVertexPointer(const GLint size, const GLenum type, const GLsizei stride, const void *pointer) {
+    capture_array_pointer(CAPTURE_glVertexPointer, size, type, stride, pointer);
+}
+void capture_glColorPointer(const GLint size, const GLenum type, const GLsizei stride, const void *pointer) {
+    capture_array_pointer(CAPTURE_glColorPointer, size, type, stride, pointer);
+}
+void capture_glTexCoordPointer(const GLint size, const GLenum type, const GLsizei stride, const void *pointer) {
+    capture_array_pointer(CAPTURE_glTexCoordPointer, size, type, stride, pointer);
+}
+
+// Client-Side Arrays
+// Everything From The Pointer To The Last Vertex Drawn Is Captured
+static void capture_client_array(const GLenum array, const array_pointer_t *pointer, const GLsizei vertices) {
+    if (pointer->buffer != 0 || pointer->pointer == NULL || vertices <= 0) {
+        return;
+    }
+    const GLsizei element_size = pointer->size * get_type_size(pointer->type);
+    const GLsizei stride = pointer->stride != 0 ? pointer->stride : element_size;
+    const uint32_t payload = capture_payload(pointer->pointer, ((size_t) (vertices - 1) * stride) + element_size);
+    begin_record(CAPTURE_CLIENT_ARRAY);
+    capture_uint(array);
+    capture_uint(pointer->size);
+    capture_uint(pointer->type);
+    capture_uint(pointer->stride);
+    capture_uint(payload);
+    end_record();
+}
+static int uses_client_array(const array_pointer_t *pointer) {
+    return pointer->enabled && pointer->buffer == 0 && pointer->pointer != NULL;
+}
+static int uses_client_arrays() {
+    // The Vertex Array Is Always Used
+    const array_pointer_t *vertex = &gl_state.array_pointers.vertex;
+    return (vertex->buffer == 0 && vertex->pointer != NULL) || uses_client_array(&gl_state.array_pointers.color) || uses_client_array(&gl_state.array_pointers.tex_coord);
+}
+static void capture_client_arrays(const GLsizei vertices) {
+    capture_client_array(GL_VERTEX_ARRAY, &gl_state.array_pointers.vertex, vertices);
+    if (gl_state.array_pointers.color.enabled) {
+        capture_client_array(GL_COLOR_ARRAY, &gl_state.array_pointers.color, vertices);
+    }
+    if (gl_state.array_pointers.tex_coord.enabled) {
+        capture_client_array(GL_TEXTURE_COORD_ARRAY, &gl_state.array_pointers.tex_coord, vertices);
+    }
+}
+
+// Drawing
+void capture_glDrawArrays(const GLenum mode, const GLint first, const GLsizei count) {
+    if (count > 0 && uses_client_arrays()) {
+        capture_client_arrays(first + count);
+    }
+    begin_record(CAPTURE_glDrawArrays);
+    capture_uint(mode);
+    capture_uint(first);
+    capture_uint(count);
+    end_record();
+}
+void capture_glMultiDrawArrays(const GLenum mode, const GLint *first, const GLsizei *count, const GLsizei drawcount) {
+    if (uses_client_arrays()) {
+        GLsizei vertices = 0;
+        for (GLsizei i = 0; i < drawcount; i++) {
+            if (count[i] > 0 && first[i] + count[i] > vertices) {
+                vertices = first[i] + count[i];
+            }
+        }
+        capture_client_arrays(vertices);
+    }
+    begin_record(CAPTURE_glMultiDrawArrays);
+    capture_uint(mode);
+    capture_uint(drawcount);
+    capture_data(first, drawcount * sizeof (GLint));
+    capture_data(count, drawcount * sizeof (GLsizei));
+    end_record();
+}
+void capture_glDrawElements(const GLenum mode, const GLsizei count, const GLenum type, const void *indices) {
+    if (count > 0 && uses_client_arrays()) {
+        GLuint min;
+        GLuint max;
+        get_index_range(type, indices, count, &min, &max);
+        capture_client_arrays(max + 1);
+    }
+    // Client-Side Indices Are A Payload, Buffer Offsets Are Stored As-Is
+    const int client_indices = get_element_array_buffer() == 0;
+    const uint32_t payload = client_indices && count > 0 ? capture_payload(indices, count * get_index_size(type)) : CAPTURE_NO_PAYLOAD;
+    begin_record(CAPTURE_glDrawElements);
+    capture_uint(mode);
+    capture_uint(count);
+    capture_uint(type);
+    capture_uint(payload);
+    capture_int64(client_indices ? 0 : (int64_t) (intptr_t) indices);
+    end_record();
+}
+
+// Display Lists
+void capture_glGenLists(const GLsizei range, const GLuint first) {
+    begin_record(CAPTURE_glGenLists);
+    capture_uint(range);
+    capture_uint(first);
+    end_record();
+}
+void capture_glDeleteLists(const GLuint list, const GLsizei range) {
+    begin_record(CAPTURE_glDeleteLists);
+    capture_uint(list);
+    capture_uint(range);
+    end_record();
+}
+void capture_glNewList(const GLuint list, const GLenum mode) {
+    begin_record(CAPTURE_glNewList);
+    capture_uint(list);
+    capture_uint(mode);
+    end_record();
+}
+void capture_glCallList(const GLuint list) {
+    begin_record(CAPTURE_glCallList);
+    capture_uint(list);
+    end_record();
+}
+void capture_glCallLists(const GLsizei n, const GLenum type, const GLvoid *lists) {
+    // Stored As GL_UNSIGNED_INT
+    begin_record(CAPTURE_glCallLists);
+    capture_uint(n);
+    for (GLsizei i = 0; i < n; i++) {
+        switch (type) {
+            case GL_UNSIGNED_BYTE: {
+                capture_uint(((const unsigned char *) lists)[i]);
+                break;
+            }
+            case GL_UNSIGNED_SHORT: {
+                capture_uint(((const unsigned short *) lists)[i]);
+                break;
+            }
+            default: {
+                capture_uint(((const GLuint *) lists)[i]);
+                break;
+            }
+        }
+    }
+    end_record();
+}
+#else
+// Compiled Out
+GLboolean start_gles_compatibility_layer_capture(__attribute__((unused)) const char *path) {
+    return 0;
+}
+void stop_gles_compatibility_layer_capture() {
+}
+void _free_gles_compatibility_layer_capture() {
+}
+void mark_gles_compatibility_layer_capture_frame() {
+}
+#endif
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <GLES/gl.h>
+
+// Included By passthrough.h After The Argument List Macros
+
+// Capture Files
+// A Header Followed By Records That Are Only Ever Appended, So A Capture Cut Short Is Still Readable Up To Its Last Record
+// Each Record Is A capture_record_t Followed By size Bytes, Padded To 4 Bytes So Payloads Can Be Used Straight From A Mapping
+// Arguments Are Stored As 4-Byte Values (Floats Keep Their Bits), Except Buffer Sizes And Offsets Which Use 8 Bytes
+#define CAPTURE_MAGIC "GLESCLC"
+// Must Be Incremented Whenever Records Or The Function List Change
+#define CAPTURE_VERSION 1
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+} capture_header_t;
+typedef struct {
+    uint32_t type;
+    uint32_t size;
+} capture_record_t;
+#define CAPTURE_ALIGN(x) (((x) + 3) & ~((size_t) 3))
+
+// Payload Indices (Payload Records Are Numbered In File Order And Never Repeated)
+#define CAPTURE_NO_PAYLOAD UINT32_MAX
+
+// Captured Entry Points
+// Written As function(name, args) When Every Argument Is Stored By Value
+// Functions With Pointer Arguments Or Object Names Are Written As custom_function(name) And Handled By Hand
+#define CAPTURE_FUNCTIONS(function, custom_function) \
+    /* Passthrough */ \
+    function(glLineWidth, ((GLfloat, width))) \
+    function(glBlendFunc, ((GLenum, sfactor), (GLenum, dfactor))) \
+    function(glClear, ((GLbitfield, mask))) \
+    custom_function(glBufferData) \
+    function(glScissor, ((GLint, x), (GLint, y), (GLsizei, width), (GLsizei, height))) \
+    function(glTexParameteri, ((GLenum, target), (GLenum, pname), (GLint, param))) \
+    function(glPolygonOffset, ((GLfloat, factor), (GLfloat, units))) \
+    function(glDepthRangef, ((GLclampf, near), (GLclampf, far))) \
+    custom_function(glBindBuffer) \
+    function(glDepthFunc, ((GLenum, func))) \
+    function(glClearColor, ((GLclampf, red), (GLclampf, green), (GLclampf, blue), (GLclampf, alpha))) \
+    function(glDepthMask, ((GLboolean, flag))) \
+    function(glHint, ((GLenum, target), (GLenum, mode))) \
+    custom_function(glDeleteBuffers) \
+    function(glColorMask, ((GLboolean, red), (GLboolean, green), (GLboolean, blue), (GLboolean, alpha))) \
+    custom_function(glGenTextures) \
+    custom_function(glBindTexture) \
+    function(glCullFace, ((GLenum, mode))) \
+    function(glViewport, ((GLint, x), (GLint, y), (GLsizei, width), (GLsizei, height))) \
+    function(glIsEnabled, ((GLenum, cap))) \
+    custom_function(glGetIntegerv) \
+    custom_function(glReadPixels) \
+    function(glShadeModel, ((GLenum, mode))) \
+    custom_function(glGenBuffers) \
+    function(glGetError, ()) \
+    custom_function(glBufferSubData) \
+    function(glPixelStorei, ((GLenum, pname), (GLint, param))) \
+    function(glNormal3f, ((GLfloat, nx), (GLfloat, ny), (GLfloat, nz))) \
+    function(glFlush, ()) \
+    function(glFinish, ()) \
+    /* State */ \
+    function(glColor4f, ((GLfloat, red), (GLfloat, green), (GLfloat, blue), (GLfloat, alpha))) \
+    custom_function(glVertexPointer) \
+    custom_function(glColorPointer) \
+    custom_function(glTexCoordPointer) \
+    function(glEnableClientState, ((GLenum, array))) \
+    function(glDisableClientState, ((GLenum, array))) \
+    function(glEnable, ((GLenum, cap))) \
+    function(glDisable, ((GLenum, cap))) \
+    function(glAlphaFunc, ((GLenum, func), (GLclampf, ref))) \
+    custom_function(glFogfv) \
+    function(glFogx, ((GLenum, pname), (GLfixed, param))) \
+    function(glFogf, ((GLenum, pname), (GLfloat, param))) \
+    custom_function(glGetFloatv) \
+    /* Matrices */ \
+    function(glMatrixMode, ((GLenum, mode))) \
+    function(glPopMatrix, ()) \
+    function(glLoadIdentity, ()) \
+    function(glPushMatrix, ()) \
+    custom_function(glMultMatrixf) \
+    function(glScalef, ((GLfloat, x), (GLfloat, y), (GLfloat, z))) \
+    function(glTranslatef, ((GLfloat, x), (GLfloat, y), (GLfloat, z))) \
+    function(glOrthof, ((GLfloat, left), (GLfloat, right), (GLfloat, bottom), (GLfloat, top), (GLfloat, near), (GLfloat, far))) \
+    function(glRotatef, ((GLfloat, angle), (GLfloat, x), (GLfloat, y), (GLfloat, z))) \
+    /* Textures */ \
+    custom_function(glTexImage2D) \
+    custom_function(glTexSubImage2D) \
+    custom_function(glDeleteTextures) \
+    /* Drawing */ \
+    custom_function(glDrawArrays) \
+    custom_function(glDrawElements) \
+    custom_function(glMultiDrawArrays) \
+    /* Immediate Mode */ \
+    function(glBegin, ((GLenum, mode))) \
+    function(glEnd, ()) \
+    function(glVertex3f, ((GLfloat, x), (GLfloat, y), (GLfloat, z))) \
+    function(glVertex2f, ((GLfloat, x), (GLfloat, y))) \
+    function(glTexCoord2f, ((GLfloat, s), (GLfloat, t))) \
+    /* Display Lists */ \
+    custom_function(glGenLists) \
+    custom_function(glDeleteLists) \
+    custom_function(glNewList) \
+    function(glEndList, ()) \
+    custom_function(glCallList) \
+    custom_function(glCallLists)
+
+// Record Types
+#define CAPTURE_RECORD_TYPE(name, ...) CAPTURE_##name,
+enum {
+    // Data Referenced By Later Records
+    CAPTURE_PAYLOAD,
+    // Client-Side Array Data Used By The Next Draw: array, size, type, stride, payload
+    CAPTURE_CLIENT_ARRAY,
+    // End Of A Frame
+    CAPTURE_FRAME,
+    CAPTURE_FUNCTIONS(CAPTURE_RECORD_TYPE, CAPTURE_RECORD_TYPE)
+};
+
+// Recording State (Per Context)
+typedef struct capture_state capture_t;
+void _free_gles_compatibility_layer_capture();
+
+// Recording
+// Only The Outermost Public Call Is Recorded, Calls The Layer Makes To Itself Are Reproduced By Replaying It
+#ifdef GLES_COMPATIBILITY_LAYER_CAPTURE
+#define CAPTURE_FUNCTION_DECLARATION(name, args) void capture_##name(GL_PARAMS(args));
+#define CAPTURE_IGNORE(name)
+CAPTURE_FUNCTIONS(CAPTURE_FUNCTION_DECLARATION, CAPTURE_IGNORE)
+// Hand-Written (Query Outputs Are Not Recorded, Generated Names Are Recorded After The Call)
+void capture_glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage);
+void capture_glBindBuffer(GLenum target, GLuint buffer);
+void capture_glDeleteBuffers(GLsizei n, const GLuint *buffers);
+void capture_glGenTextures(GLsizei n, const GLuint *textures);
+void capture_glBindTexture(GLenum target, GLuint texture);
+void capture_glGetIntegerv(GLenum pname);
+void capture_glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type);
+void capture_glGenBuffers(GLsizei n, const GLuint *buffers);
+void capture_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
+void capture_glVertexPointer(GLint size, GLenum type, GLsizei stride, const void *pointer);
+void capture_glColorPointer(GLint size, GLenum type, GLsizei stride, const void *pointer);
+void capture_glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const void *pointer);
+void capture_glFogfv(GLenum pname, const GLfloat *params);
+void capture_glGetFloatv(GLenum pname);
+void capture_glMultMatrixf(const GLfloat *m);
+void capture_glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels);
+void capture_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels);
+void capture_glDeleteTextures(GLsizei n, const GLuint *textures);
+void capture_glDrawArrays(GLenum mode, GLint first, GLsizei count);
+void capture_glDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices);
+void capture_glMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount);
+void capture_glGenLists(GLsizei range, GLuint first);
+void capture_glDeleteLists(GLuint list, GLsizei range);
+void capture_glNewList(GLuint list, GLenum mode);
+void capture_glCallList(GLuint list);
+void capture_glCallLists(GLsizei n, GLenum type, const GLvoid *lists);
+
+// Tracks How Deeply Public Calls Are Nested On This Thread (Returns Whether The Call Should Be Recorded)
+int begin_capture_scope();
+void end_capture_scope(const int *scope);
+#define CAPTURE_SCOPE() __attribute__((cleanup(end_capture_scope))) const int capture_scope = begin_capture_scope()
+// Records A Call Before It Runs
+#define CAPTURE(name, args) \
+    CAPTURE_SCOPE(); \
+    if (capture_scope) { \
+        capture_##name args; \
+    }
+// Records A Call Once Its Results Are Known (Requires CAPTURE_SCOPE() At The Start Of The Function)
+#define CAPTURE_RESULT(name, args) \
+    if (capture_scope) { \
+        capture_##name args; \
+    }
+#else
+#define CAPTURE_SCOPE()
+#define CAPTURE(name, args)
+#define CAPTURE_RESULT(name, args)
+#endif
@@ -0,0 +1,116 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "log.h"
+
+// Current Context
+__thread gles_compatibility_layer_context_t *current_context = NULL;
+
+// Share Groups
+static share_group_t *create_share_group() {
+    share_group_t *share_group = calloc(1, sizeof (share_group_t));
+    ALLOC_CHECK(share_group);
+    // Recursive, Because Replaying Or Deleting Lists Makes GL Calls That Update Element Buffers
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    if (pthread_mutex_init(&share_group->lock, &attributes) != 0) {
+        ERR("Unable To Create Share Group Lock");
+    }
+    pthread_mutexattr_destroy(&attributes);
+    return share_group;
+}
+static void release_share_group(share_group_t *share_group) {
+    pthread_mutex_lock(&share_group->lock);
+    const unsigned int references = --share_group->references;
+    pthread_mutex_unlock(&share_group->lock);
+    if (references == 0) {
+        _free_gles_compatibility_layer_elements(&share_group->elements);
+        _free_gles_compatibility_layer_lists(&share_group->lists);
+        _free_gles_compatibility_layer_tracked_textures(&share_group->textures);
+        pthread_mutex_destroy(&share_group->lock);
+        free(share_group);
+    }
+}
+void lock_share_group() {
+    pthread_mutex_lock(&current_context->share_group->lock);
+}
+void unlock_share_group() {
+    pthread_mutex_unlock(&current_context->share_group->lock);
+}
+
+// Make Current
+void make_gles_compatibility_layer_context_current(gles_compatibility_layer_context_t *context) {
+    current_context = context;
+    if (context == NULL) {
+        gl_dispatch = NULL;
+    } else if (context == gl_thread_context && !is_gl_thread) {
+        gl_dispatch = &gl_queue_dispatch;
+    } else {
+        gl_dispatch = &context->dispatch;
+    }
+}
+gles_compatibility_layer_context_t *get_current_gles_compatibility_layer_context() {
+    return current_context;
+}
+
+// Create
+gles_compatibility_layer_context_t *create_gles_compatibility_layer_context(const getProcAddress_t get_proc_address, gles_compatibility_layer_context_t *share_context) {
+    // Allocate (State Is Cache Line Aligned)
+    gles_compatibility_layer_context_t *context = NULL;
+    if (posix_memalign((void **) &context, _Alignof(gles_compatibility_layer_context_t), sizeof (gles_compatibility_layer_context_t)) != 0) {
+        context = NULL;
+    }
+    ALLOC_CHECK(context);
+    memset(context, 0, sizeof (gles_compatibility_layer_context_t));
+
+    // Share Group
+    context->share_group = share_context != NULL ? share_context->share_group : create_share_group();
+    pthread_mutex_lock(&context->share_group->lock);
+    context->share_group->references++;
+    pthread_mutex_unlock(&context->share_group->lock);
+
+    // Resolve Functions
+    current_context = context;
+    _init_gles_compatibility_layer_dispatch(get_proc_address);
+    make_gles_compatibility_layer_context_current(context);
+
+    // State
+    _init_gles_compatibility_layer_state();
+    _init_gles_compatibility_layer_draw();
+    return context;
+}
+
+// Destroy
+static gles_compatibility_layer_context_t *default_context = NULL;
+void destroy_gles_compatibility_layer_context(gles_compatibility_layer_context_t *context) {
+    if (context == NULL) {
+        return;
+    }
+    if (context == gl_thread_context) {
+        ERR("Context Is Used By The Submission Thread");
+    }
+    // Module Data Is Freed Through The Current Context
+    gles_compatibility_layer_context_t *previous_context = current_context;
+    current_context = context;
+    _free_gles_compatibility_layer_state();
+    _free_gles_compatibility_layer_draw();
+    _free_gles_compatibility_layer_immediate();
+    _free_gles_compatibility_layer_list_context();
+    _free_gles_compatibility_layer_textures();
+    _free_gles_compatibility_layer_program_cache();
+    _free_gles_compatibility_layer_capture();
+    release_share_group(context->share_group);
+    if (context == default_context) {
+        default_context = NULL;
+    }
+    free(context);
+    make_gles_compatibility_layer_context_current(previous_context == context ? NULL : previous_context);
+}
+
+// Default Context
+void init_gles_compatibility_layer(const getProcAddress_t new_getProcAddress) {
+    destroy_gles_compatibility_layer_context(default_context);
+    default_context = create_gles_compatibility_layer_context(new_getProcAddress, NULL);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <pthread.h>
+
+#include <GLES/gl.h>
+
+#include "state.h"
+#include "passthrough.h"
+#include "draw.h"
+#include "stream.h"
+#include "list.h"
+#include "elements.h"
+#include "texture.h"
+#include "program_cache.h"
+
+// Share Group
+// Layer Copies Of Objects The Real Contexts Share, Guarded By The Lock Because Sharing Contexts Run On Different Threads
+typedef struct {
+    pthread_mutex_t lock;
+    unsigned int references;
+    element_buffers_t elements;
+    display_lists_t lists;
+    tracked_textures_t textures;
+    // Bumped When Buffers Are Deleted, So Other Contexts Drop VAOs That May Reference Them
+    unsigned int buffer_deletions;
+} share_group_t;
+void lock_share_group();
+void unlock_share_group();
+
+// Context
+// Everything The Layer Tracks For One Real Context, Current On At Most One Thread At A Time
+struct gles_compatibility_layer_context {
+    // Hot (Checked By Almost Every Call)
+    struct {
+        GLsizei draws;
+        GLsizei immediate_size;
+    } pending;
+    gl_state_t state;
+    draw_context_t draw;
+    immediate_context_t immediate;
+    list_context_t list;
+    stream_context_t stream;
+    texture_context_t textures;
+    // Cold
+    gl_dispatch_t dispatch;
+    gl_capabilities_t capabilities;
+    program_cache_context_t program_cache;
+    share_group_t *share_group;
+    // Open Capture File (NULL When Not Capturing)
+    capture_t *capture;
+};
+extern __thread gles_compatibility_layer_context_t *current_context;
+#define gl_state (current_context->state)
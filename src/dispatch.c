@@ -0,0 +1,35 @@
+#include "context.h"
+
+// Tables
+gl_dispatch_t gl_queue_dispatch;
+__thread const gl_dispatch_t *gl_dispatch = NULL;
+
+// Resolve Functions
+#define GL_RESOLVE(name) (current_context->dispatch.name = (real_##name##_t) new_getProcAddress(#name))
+#define GL_RESOLVE_REQUIRED(name, return_type, args) \
+    if (!GL_RESOLVE(name)) { \
+        ERR("Error Resolving GL Symbol: " #name); \
+    }
+#define GL_RESOLVE_OPTIONAL(name, return_type, args) \
+    current_context->capabilities.name = GL_RESOLVE(name) != NULL;
+void _init_gles_compatibility_layer_dispatch(const getProcAddress_t new_getProcAddress) {
+    GL_DISPATCH_FUNCTIONS(GL_RESOLVE_REQUIRED, GL_RESOLVE_OPTIONAL)
+}
+
+// Instrumentation
+#ifdef GLES_COMPATIBILITY_LAYER_INSTRUMENTATION
+#define GL_INSTRUMENTED(name, return_type, args) \
+    static return_type GL_APIENTRY instrumented_##name(GL_PARAMS(args)) { \
+        if (SHOULD_QUEUE()) { \
+            INSTRUMENT_SCOPE(#name, GLES_COMPATIBILITY_LAYER_QUEUED_CALL); \
+            return gl_queue_dispatch.name(GL_ARGS(args)); \
+        } \
+        INSTRUMENT_SCOPE(#name, GLES_COMPATIBILITY_LAYER_DRIVER_CALL); \
+        return gl_dispatch->name(GL_ARGS(args)); \
+    }
+GL_DISPATCH_FUNCTIONS(GL_INSTRUMENTED, GL_INSTRUMENTED)
+#define GL_INSTRUMENTED_ENTRY(name, return_type, args) .name = instrumented_##name,
+const gl_dispatch_t gl_instrumented_dispatch = {
+    GL_DISPATCH_FUNCTIONS(GL_INSTRUMENTED_ENTRY, GL_INSTRUMENTED_ENTRY)
+};
+#endif
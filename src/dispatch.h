@@ -0,0 +1,128 @@
+#pragma once
+
+// Included By passthrough.h After The Argument List Macros
+
+// Every Real GL Function Used By The Layer
+// Written As function(name, return_type, args), Optional Functions May Be Missing From The Driver
+#define GL_DISPATCH_FUNCTIONS(function, optional_function) \
+    /* Passthrough */ \
+    function(glLineWidth, void, ((GLfloat, width))) \
+    function(glBlendFunc, void, ((GLenum, sfactor), (GLenum, dfactor))) \
+    function(glClear, void, ((GLbitfield, mask))) \
+    function(glBufferData, void, ((GLenum, target), (GLsizeiptr, size), (const void *, data), (GLenum, usage))) \
+    function(glScissor, void, ((GLint, x), (GLint, y), (GLsizei, width), (GLsizei, height))) \
+    function(glTexParameteri, void, ((GLenum, target), (GLenum, pname), (GLint, param))) \
+    function(glPolygonOffset, void, ((GLfloat, factor), (GLfloat, units))) \
+    function(glDepthRangef, void, ((GLclampf, near), (GLclampf, far))) \
+    function(glBindBuffer, void, ((GLenum, target), (GLuint, buffer))) \
+    function(glDepthFunc, void, ((GLenum, func))) \
+    function(glClearColor, void, ((GLclampf, red), (GLclampf, green), (GLclampf, blue), (GLclampf, alpha))) \
+    function(glDepthMask, void, ((GLboolean, flag))) \
+    function(glHint, void, ((GLenum, target), (GLenum, mode))) \
+    function(glDeleteBuffers, void, ((GLsizei, n), (const GLuint *, buffers))) \
+    function(glColorMask, void, ((GLboolean, red), (GLboolean, green), (GLboolean, blue), (GLboolean, alpha))) \
+    function(glGenTextures, void, ((GLsizei, n), (GLuint *, textures))) \
+    function(glBindTexture, void, ((GLenum, target), (GLuint, texture))) \
+    function(glCullFace, void, ((GLenum, mode))) \
+    function(glViewport, void, ((GLint, x), (GLint, y), (GLsizei, width), (GLsizei, height))) \
+    function(glIsEnabled, GLboolean, ((GLenum, cap))) \
+    function(glGetIntegerv, void, ((GLenum, pname), (GLint *, data))) \
+    function(glReadPixels, void, ((GLint, x), (GLint, y), (GLsizei, width), (GLsizei, height), (GLenum, format), (GLenum, type), (void *, data))) \
+    function(glGenBuffers, void, ((GLsizei, n), (GLuint *, buffers))) \
+    function(glGetError, GLenum, ()) \
+    function(glBufferSubData, void, ((GLenum, target), (GLintptr, offset), (GLsizeiptr, size), (const void *, data))) \
+    function(glPixelStorei, void, ((GLenum, pname), (GLint, param))) \
+    function(glFlush, void, ()) \
+    function(glFinish, void, ()) \
+    /* State */ \
+    function(glEnable, void, ((GLenum, cap))) \
+    function(glDisable, void, ((GLenum, cap))) \
+    function(glGetFloatv, void, ((GLenum, pname), (GLfloat *, params))) \
+    /* Textures */ \
+    function(glTexImage2D, void, ((GLenum, target), (GLint, level), (GLint, internalformat), (GLsizei, width), (GLsizei, height), (GLint, border), (GLenum, format), (GLenum, type), (const void *, pixels))) \
+    function(glTexSubImage2D, void, ((GLenum, target), (GLint, level), (GLint, xoffset), (GLint, yoffset), (GLsizei, width), (GLsizei, height), (GLenum, format), (GLenum, type), (const void *, pixels))) \
+    function(glDeleteTextures, void, ((GLsizei, n), (const GLuint *, textures))) \
+    /* Drawing */ \
+    function(glUseProgram, void, ((GLuint, program))) \
+    function(glGetUniformLocation, GLint, ((GLuint, program), (const GLchar *, name))) \
+    function(glUniformMatrix4fv, void, ((GLint, location), (GLsizei, count), (GLboolean, transpose), (const GLfloat *, value))) \
+    function(glUniform1i, void, ((GLint, location), (GLint, v0))) \
+    function(glUniform1f, void, ((GLint, location), (GLfloat, v0))) \
+    function(glUniform4f, void, ((GLint, location), (GLfloat, v0), (GLfloat, v1), (GLfloat, v2), (GLfloat, v3))) \
+    function(glBindAttribLocation, void, ((GLuint, program), (GLuint, index), (const GLchar *, name))) \
+    function(glEnableVertexAttribArray, void, ((GLuint, index))) \
+    function(glDisableVertexAttribArray, void, ((GLuint, index))) \
+    function(glVertexAttribPointer, void, ((GLuint, index), (GLint, size), (GLenum, type), (GLboolean, normalized), (GLsizei, stride), (const void *, pointer))) \
+    function(glDrawArrays, void, ((GLenum, mode), (GLint, first), (GLsizei, count))) \
+    function(glDrawElements, void, ((GLenum, mode), (GLsizei, count), (GLenum, type), (const void *, indices))) \
+    function(glGetString, const unsigned char *, ((GLenum, name))) \
+    optional_function(glMultiDrawArraysEXT, void, ((GLenum, mode), (const GLint *, first), (const GLsizei *, count), (GLsizei, drawcount))) \
+    /* Vertex Array Objects (Core On ES 3.0, GL_OES_vertex_array_object On ES 2.0) */ \
+    optional_function(glGenVertexArrays, void, ((GLsizei, n), (GLuint *, arrays))) \
+    optional_function(glBindVertexArray, void, ((GLuint, array))) \
+    optional_function(glDeleteVertexArrays, void, ((GLsizei, n), (const GLuint *, arrays))) \
+    optional_function(glGenVertexArraysOES, void, ((GLsizei, n), (GLuint *, arrays))) \
+    optional_function(glBindVertexArrayOES, void, ((GLuint, array))) \
+    optional_function(glDeleteVertexArraysOES, void, ((GLsizei, n), (const GLuint *, arrays))) \
+    /* Uniform Buffers (ES 3.0) */ \
+    optional_function(glBindBufferRange, void, ((GLenum, target), (GLuint, index), (GLuint, buffer), (GLintptr, offset), (GLsizeiptr, size))) \
+    optional_function(glGetUniformBlockIndex, GLuint, ((GLuint, program), (const GLchar *, uniformBlockName))) \
+    optional_function(glUniformBlockBinding, void, ((GLuint, program), (GLuint, uniformBlockIndex), (GLuint, uniformBlockBinding))) \
+    /* Shaders */ \
+    function(glCreateShader, GLuint, ((GLenum, type))) \
+    function(glShaderSource, void, ((GLuint, shader), (GLsizei, count), (const GLchar *const *, string), (const GLint *, length))) \
+    function(glCompileShader, void, ((GLuint, shader))) \
+    function(glCreateProgram, GLuint, ()) \
+    function(glAttachShader, void, ((GLuint, program), (GLuint, shader))) \
+    function(glLinkProgram, void, ((GLuint, program))) \
+    function(glGetShaderiv, void, ((GLuint, shader), (GLenum, pname), (GLint *, params))) \
+    function(glGetShaderInfoLog, void, ((GLuint, shader), (GLsizei, bufSize), (GLsizei *, length), (GLchar *, infoLog))) \
+    function(glGetProgramiv, void, ((GLuint, program), (GLenum, pname), (GLint *, params))) \
+    function(glGetProgramInfoLog, void, ((GLuint, program), (GLsizei, bufSize), (GLsizei *, length), (GLchar *, infoLog))) \
+    function(glDetachShader, void, ((GLuint, program), (GLuint, shader))) \
+    function(glDeleteShader, void, ((GLuint, shader))) \
+    optional_function(glMaxShaderCompilerThreadsKHR, void, ((GLuint, count))) \
+    /* Program Binaries */ \
+    optional_function(glGetProgramBinaryOES, void, ((GLuint, program), (GLsizei, bufSize), (GLsizei *, length), (GLenum *, binaryFormat), (void *, binary))) \
+    optional_function(glProgramBinaryOES, void, ((GLuint, program), (GLenum, binaryFormat), (const void *, binary), (GLint, length)))
+
+// Function Types
+#define GL_DISPATCH_TYPE(name, return_type, args) typedef return_type (GL_APIENTRY *real_##name##_t)(GL_PARAMS(args));
+GL_DISPATCH_FUNCTIONS(GL_DISPATCH_TYPE, GL_DISPATCH_TYPE)
+
+// Dispatch Table
+#define GL_DISPATCH_ENTRY(name, return_type, args) real_##name##_t name;
+typedef struct {
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_ENTRY, GL_DISPATCH_ENTRY)
+} gl_dispatch_t;
+// Functions That Encode Calls For The Submission Thread (Filled In By GL_FUNC)
+extern gl_dispatch_t gl_queue_dispatch;
+// Table Used By This Thread, Either The Current Context's Driver Functions Or gl_queue_dispatch
+extern __thread const gl_dispatch_t *gl_dispatch;
+
+// Capabilities (Whether Each Optional Function Was Resolved)
+#define GL_DISPATCH_CAPABILITY(name, return_type, args) unsigned char name;
+#define GL_DISPATCH_IGNORE(name, return_type, args)
+typedef struct {
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_IGNORE, GL_DISPATCH_CAPABILITY)
+} gl_capabilities_t;
+#define HAS_GL_FUNC(name) (current_context->capabilities.name)
+
+// Resolves Every Function Once Into The Current Context
+void _init_gles_compatibility_layer_dispatch(getProcAddress_t new_getProcAddress);
+
+// Accessors
+#ifdef GLES_COMPATIBILITY_LAYER_INSTRUMENTATION
+// Timed Wrappers That Call Through gl_dispatch
+extern const gl_dispatch_t gl_instrumented_dispatch;
+#define GL_DISPATCH_ACCESSOR(name, return_type, args) \
+    static inline real_##name##_t real_##name() { \
+        return gl_instrumented_dispatch.name; \
+    }
+#else
+#define GL_DISPATCH_ACCESSOR(name, return_type, args) \
+    static inline real_##name##_t real_##name() { \
+        return gl_dispatch->name; \
+    }
+#endif
+GL_DISPATCH_FUNCTIONS(GL_DISPATCH_ACCESSOR, GL_DISPATCH_ACCESSOR)
@@ -1,7 +1,14 @@
 #include <math.h>
+#include <string.h>
 
-#include "state.h"
+#include "context.h"
 #include "passthrough.h"
+#include "stream.h"
+#include "elements.h"
+#include "texture.h"
+#include "program_cache.h"
+#include "draw.h"
+#include "list.h"
 #include "log.h"
 
 #include <GLES/gl.h>
@@ -11,238 +18,957 @@
 #define REAL_GL_VERTEX_SHADER 0x8b31
 #define REAL_GL_INFO_LOG_LENGTH 0x8b84
 #define REAL_GL_COMPILE_STATUS 0x8b81
-GL_FUNC(glUseProgram, void, (GLuint program));
-GL_FUNC(glGetUniformLocation, GLint, (GLuint program, const GLchar *name));
-GL_FUNC(glUniformMatrix4fv, void, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value));
-GL_FUNC(glUniform1i, void, (GLint location, GLint v0));
-GL_FUNC(glUniform1f, void, (GLint location, GLfloat v0));
-GL_FUNC(glUniform3f, void, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2));
-GL_FUNC(glUniform4f, void, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3));
-GL_FUNC(glGetAttribLocation, GLint, (GLuint program, const GLchar *name));
-GL_FUNC(glEnableVertexAttribArray, void, (GLuint index));
-GL_FUNC(glDisableVertexAttribArray, void, (GLuint index));
-GL_FUNC(glVertexAttribPointer, void, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer));
-GL_FUNC(glVertexAttrib3f, void, (GLuint index, GLfloat v0, GLfloat v1, GLfloat v2));
-GL_FUNC(glVertexAttrib4f, void, (GLuint index, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3));
-GL_FUNC(glCreateShader, GLuint, (GLenum type));
-GL_FUNC(glShaderSource, void, (GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length));
-GL_FUNC(glCompileShader, void, (GLuint shader));
-GL_FUNC(glCreateProgram, GLuint, ());
-GL_FUNC(glAttachShader, void, (GLuint program, GLuint shader));
-GL_FUNC(glLinkProgram, void, (GLuint program));
-GL_FUNC(glGetShaderiv, void, (GLuint shader, GLenum pname, GLint *params));
-GL_FUNC(glGetShaderInfoLog, void, (GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog));
-
-// Compile Shader
-static void log_shader(GLuint shader, const char *name) {
-    // Log
-    GLint log_length = 0;
-    real_glGetShaderiv()(shader, REAL_GL_INFO_LOG_LENGTH, &log_length);
+#define REAL_GL_LINK_STATUS 0x8b82
+#define REAL_GL_EXTENSIONS 0x1f03
+#define REAL_GL_RENDERER 0x1f01
+#define REAL_GL_VERSION 0x1f02
+
+// Attribute Locations (Bound Before Linking, So They Are Shared By All Programs)
+#define ATTRIB_VERTEX_COORDS 0
+#define ATTRIB_COLOR 1
+#define ATTRIB_TEXTURE_COORDS 2
+
+// Functions
+GL_FUNC(glUseProgram, void, ((GLuint, program)));
+GL_FUNC_RETURN(glGetUniformLocation, GLint, ((GLuint, program), (const GLchar *, name)));
+GL_FUNC_COPY(glUniformMatrix4fv, void, ((GLint, location), (GLsizei, count), (GLboolean, transpose), (const GLfloat *, value)), ((value, count * 16 * sizeof (GLfloat))));
+GL_FUNC(glUniform1i, void, ((GLint, location), (GLint, v0)));
+GL_FUNC(glUniform1f, void, ((GLint, location), (GLfloat, v0)));
+GL_FUNC(glUniform4f, void, ((GLint, location), (GLfloat, v0), (GLfloat, v1), (GLfloat, v2), (GLfloat, v3)));
+GL_FUNC_COPY(glBindAttribLocation, void, ((GLuint, program), (GLuint, index), (const GLchar *, name)), ((name, strlen(name) + 1)));
+GL_FUNC(glEnableVertexAttribArray, void, ((GLuint, index)));
+GL_FUNC(glDisableVertexAttribArray, void, ((GLuint, index)));
+GL_FUNC(glVertexAttribPointer, void, ((GLuint, index), (GLint, size), (GLenum, type), (GLboolean, normalized), (GLsizei, stride), (const void *, pointer)));
+GL_FUNC_SYNC(glGenVertexArrays, void, ((GLsizei, n), (GLuint *, arrays)));
+GL_FUNC(glBindVertexArray, void, ((GLuint, array)));
+GL_FUNC_COPY(glDeleteVertexArrays, void, ((GLsizei, n), (const GLuint *, arrays)), ((arrays, n * sizeof (GLuint))));
+GL_FUNC_SYNC(glGenVertexArraysOES, void, ((GLsizei, n), (GLuint *, arrays)));
+GL_FUNC(glBindVertexArrayOES, void, ((GLuint, array)));
+GL_FUNC_COPY(glDeleteVertexArraysOES, void, ((GLsizei, n), (const GLuint *, arrays)), ((arrays, n * sizeof (GLuint))));
+GL_FUNC(glBindBufferRange, void, ((GLenum, target), (GLuint, index), (GLuint, buffer), (GLintptr, offset), (GLsizeiptr, size)));
+GL_FUNC_RETURN(glGetUniformBlockIndex, GLuint, ((GLuint, program), (const GLchar *, uniformBlockName)));
+GL_FUNC(glUniformBlockBinding, void, ((GLuint, program), (GLuint, uniformBlockIndex), (GLuint, uniformBlockBinding)));
+GL_FUNC_RETURN(glCreateShader, GLuint, ((GLenum, type)));
+GL_FUNC_SYNC(glShaderSource, void, ((GLuint, shader), (GLsizei, count), (const GLchar *const *, string), (const GLint *, length)));
+GL_FUNC(glCompileShader, void, ((GLuint, shader)));
+GL_FUNC_RETURN(glCreateProgram, GLuint, ());
+GL_FUNC(glAttachShader, void, ((GLuint, program), (GLuint, shader)));
+GL_FUNC(glLinkProgram, void, ((GLuint, program)));
+GL_FUNC_SYNC(glGetShaderiv, void, ((GLuint, shader), (GLenum, pname), (GLint *, params)));
+GL_FUNC_SYNC(glGetShaderInfoLog, void, ((GLuint, shader), (GLsizei, bufSize), (GLsizei *, length), (GLchar *, infoLog)));
+GL_FUNC_SYNC(glGetProgramInfoLog, void, ((GLuint, program), (GLsizei, bufSize), (GLsizei *, length), (GLchar *, infoLog)));
+GL_FUNC(glDetachShader, void, ((GLuint, program), (GLuint, shader)));
+GL_FUNC(glDeleteShader, void, ((GLuint, shader)));
+GL_FUNC(glMaxShaderCompilerThreadsKHR, void, ((GLuint, count)));
+GL_FUNC_RETURN(glGetString, const unsigned char *, ((GLenum, name)));
+
+// Shader Logs
+// Reading A Log Or Status Waits For The Driver To Finish Compiling, So This Is Only Done On Failure (Or When Requested)
+#ifdef GLES_COMPATIBILITY_LAYER_SHADER_LOGS
+#define ALWAYS_LOG_SHADERS 1
+#else
+#define ALWAYS_LOG_SHADERS 0
+#endif
+static void print_log(const char *name, GLint log_length, real_glGetShaderInfoLog_t get_log, const GLuint object) {
     GLchar *log = malloc(log_length * sizeof (GLchar));
     ALLOC_CHECK(log);
-    real_glGetShaderInfoLog()(shader, log_length, &log_length, log);
+    get_log(object, log_length, &log_length, log);
     if (log_length > 0) {
         if (log_length > 1 && log[log_length - 1] == '\n') {
             log[log_length - 1] = '\0';
         }
-        DEBUG("%s Shader Compile Log: %s", name, log);
+        DEBUG("%s Log: %s", name, log);
     }
     free(log);
+}
+static int log_shader(const GLuint shader, const char *name) {
+    // Log
+    GLint log_length = 0;
+    real_glGetShaderiv()(shader, REAL_GL_INFO_LOG_LENGTH, &log_length);
+    if (log_length > 0) {
+        print_log(name, log_length, real_glGetShaderInfoLog(), shader);
+    }
 
     // Check Status
     GLint is_compiled = 0;
     real_glGetShaderiv()(shader, REAL_GL_COMPILE_STATUS, &is_compiled);
-    if (!is_compiled) {
-        ERR("Failed To Compile %s Shader", name);
+    return is_compiled;
+}
+static void log_program(const GLuint program) {
+    GLint log_length = 0;
+    real_glGetProgramiv()(program, REAL_GL_INFO_LOG_LENGTH, &log_length);
+    if (log_length > 0) {
+        print_log("Program Link", log_length, real_glGetProgramInfoLog(), program);
     }
 }
-static GLuint compile_shader(const char *vertex_shader_text, const int vertex_shader_length, const char *fragment_shader_text, const int fragment_shader_length) {
-    // Vertex Shader
-    const GLuint vertex_shader = real_glCreateShader()(REAL_GL_VERTEX_SHADER);
-    real_glShaderSource()(vertex_shader, 1, &vertex_shader_text, &vertex_shader_length);
-    real_glCompileShader()(vertex_shader);
-    log_shader(vertex_shader, "Vertex");
-
-    // Fragment Shader
-    const GLuint fragment_shader = real_glCreateShader()(REAL_GL_FRAGMENT_SHADER);
-    real_glShaderSource()(fragment_shader, 1, &fragment_shader_text, &fragment_shader_length);
-    real_glCompileShader()(fragment_shader);
-    log_shader(fragment_shader, "Fragment");
 
-    // Link
-    GLuint program = real_glCreateProgram()();
+// Compile Shader (Without Waiting For The Result)
+static void shader_source(GLuint shader, const char *defines, const char *text, const int length) {
+    // Insert Defines After #version
+    const char *version_end = memchr(text, '\n', length);
+    const int version_length = version_end != NULL ? (version_end - text) + 1 : 0;
+    const GLchar *strings[] = {text, defines, text + version_length};
+    const GLint lengths[] = {version_length, strlen(defines), length - version_length};
+    real_glShaderSource()(shader, 3, strings, lengths);
+}
+static GLuint compile_shader(const GLenum type, const char *defines, const char *text, const int length) {
+    const GLuint shader = real_glCreateShader()(type);
+    shader_source(shader, defines, text, length);
+    real_glCompileShader()(shader);
+    return shader;
+}
+static void link_program(const GLuint program, const GLuint vertex_shader, const GLuint fragment_shader) {
     real_glAttachShader()(program, vertex_shader);
     real_glAttachShader()(program, fragment_shader);
+    real_glBindAttribLocation()(program, ATTRIB_VERTEX_COORDS, "a_vertex_coords");
+    real_glBindAttribLocation()(program, ATTRIB_COLOR, "a_color");
+    real_glBindAttribLocation()(program, ATTRIB_TEXTURE_COORDS, "a_texture_coords");
     real_glLinkProgram()(program);
-
-    // Return
-    return program;
 }
 
-// Reset Static Variables
-typedef struct {
-    GLint *variable;
-    GLint default_value;
-} static_variable_t;
-static static_variable_t variables_to_reset[64];
-static int variables_to_reset_size = 0;
-static void mark_for_reset(GLint *variable) {
-    static_variable_t variable_obj;
-    variable_obj.variable = variable;
-    variable_obj.default_value = *variable;
-    variables_to_reset[variables_to_reset_size++] = variable_obj;
-}
-static void reset_variables() {
-    for (int i = 0; i < variables_to_reset_size; i++) {
-        static_variable_t variable_obj = variables_to_reset[i];
-        *variable_obj.variable = variable_obj.default_value;
-    }
-    variables_to_reset_size = 0;
-}
-
-// Shader
+// Per-Context Programs
+#define programs (current_context->draw.programs)
+#define current_program (current_context->draw.current_program)
+#define compiling_programs (current_context->draw.compiling_programs)
+#define uniform_buffer (current_context->draw.uniform_buffer)
+#define UNIFORM_BUFFER_BINDING 0
 extern unsigned char main_vsh[];
 extern size_t main_vsh_len;
 extern unsigned char main_fsh[];
 extern size_t main_fsh_len;
-static GLuint get_shader() {
-    static GLuint program = 0;
-    if (program == 0) {
-        mark_for_reset((GLint *) &program);
-        program = compile_shader((const char *) main_vsh, main_vsh_len, (const char *) main_fsh, main_fsh_len);
+extern unsigned char main_es3_vsh[];
+extern size_t main_es3_vsh_len;
+extern unsigned char main_es3_fsh[];
+extern size_t main_es3_fsh_len;
+// The ES 3.0 Variants Read Their State From The Uniform Buffer
+#define vertex_shader_source ((const char *) (uniform_buffer.enabled ? main_es3_vsh : main_vsh))
+#define vertex_shader_length (uniform_buffer.enabled ? main_es3_vsh_len : main_vsh_len)
+#define fragment_shader_source ((const char *) (uniform_buffer.enabled ? main_es3_fsh : main_fsh))
+#define fragment_shader_length (uniform_buffer.enabled ? main_es3_fsh_len : main_fsh_len)
+#define add_define(feature, name) \
+    if (features & (feature)) { \
+        strcat(defines, "#define " name "\n"); \
     }
-    return program;
+static void get_defines(const int features, char *defines) {
+    defines[0] = '\0';
+    add_define(PROGRAM_TEXTURE, "TEXTURE");
+    add_define(PROGRAM_COLOR_ARRAY, "COLOR_ARRAY");
+    add_define(PROGRAM_ALPHA_TEST, "ALPHA_TEST");
+    add_define(PROGRAM_FOG_LINEAR | PROGRAM_FOG_EXP, "FOG");
+    add_define(PROGRAM_FOG_LINEAR, "FOG_LINEAR");
+    add_define(PROGRAM_FOG_EXP, "FOG_EXP");
+    add_define(PROGRAM_TEXTURE_MATRIX, "TEXTURE_MATRIX");
 }
+static void compile_program(program_t *program, const char *defines) {
+    program->vertex_shader = compile_shader(REAL_GL_VERTEX_SHADER, defines, vertex_shader_source, vertex_shader_length);
+    program->fragment_shader = compile_shader(REAL_GL_FRAGMENT_SHADER, defines, fragment_shader_source, fragment_shader_length);
+    link_program(program->id, program->vertex_shader, program->fragment_shader);
+}
+// Start Building A Program
+static void start_program(const int features) {
+    program_t *program = &programs[features];
+    if (program->id != 0) {
+        return;
+    }
+    char defines[256];
+    get_defines(features, defines);
 
-// Init
-void init_gles_compatibility_layer(getProcAddress_t new_getProcAddress) {
-    // Setup Passthrough
-    getProcAddress = new_getProcAddress;
+    // Load From The Cache Or Compile
+    const char *sources[] = {defines, vertex_shader_source, fragment_shader_source};
+    const size_t lengths[] = {strlen(defines), vertex_shader_length, fragment_shader_length};
+    program->cache_key = get_program_cache_key(sources, lengths, 3);
+    program->id = real_glCreateProgram()();
+    program->ready = 0;
+    compiling_programs.size++;
+    program->vertex_shader = 0;
+    program->fragment_shader = 0;
+    if (!load_program_binary(program->id, program->cache_key)) {
+        compile_program(program, defines);
+    }
+}
+// Check The Result And Set Up Uniforms
+#define find_uniform(name) program->uniforms.name = real_glGetUniformLocation()(program->id, "u_" #name)
+static void finish_program(program_t *program, const int features) {
+    // Check Status (Waits For The Compiler)
+    GLint is_linked = 0;
+    real_glGetProgramiv()(program->id, REAL_GL_LINK_STATUS, &is_linked);
+    if (!is_linked && program->vertex_shader == 0) {
+        // The Driver Rejected The Cached Binary
+        DEBUG("Cached Program Binary Rejected, Recompiling");
+        char defines[256];
+        get_defines(features, defines);
+        compile_program(program, defines);
+        real_glGetProgramiv()(program->id, REAL_GL_LINK_STATUS, &is_linked);
+    }
+    if (!is_linked || ALWAYS_LOG_SHADERS) {
+        int is_compiled = 1;
+        if (program->vertex_shader != 0) {
+            is_compiled = log_shader(program->vertex_shader, "Vertex Shader Compile") && is_compiled;
+            is_compiled = log_shader(program->fragment_shader, "Fragment Shader Compile") && is_compiled;
+        }
+        log_program(program->id);
+        if (!is_compiled) {
+            ERR("Failed To Compile Shader");
+        } else if (!is_linked) {
+            ERR("Failed To Link Program");
+        }
+    }
 
-    // State
-    _init_gles_compatibility_layer_state();
+    // Save Newly Compiled Programs
+    if (program->vertex_shader != 0) {
+        save_program_binary(program->id, program->cache_key);
+        real_glDetachShader()(program->id, program->vertex_shader);
+        real_glDetachShader()(program->id, program->fragment_shader);
+        real_glDeleteShader()(program->vertex_shader);
+        real_glDeleteShader()(program->fragment_shader);
+        program->vertex_shader = 0;
+        program->fragment_shader = 0;
+    }
 
-    // Reset Static Variables
-    reset_variables();
+    // Find Uniforms
+    find_uniform(texture_unit);
+    if (uniform_buffer.enabled) {
+        // Everything Else Is In The Uniform Buffer
+        real_glUniformBlockBinding()(program->id, real_glGetUniformBlockIndex()(program->id, "fixed_function"), UNIFORM_BUFFER_BINDING);
+    } else {
+        find_uniform(projection_model_view);
+        find_uniform(model_view);
+        find_uniform(texture);
+        find_uniform(color);
+        find_uniform(fog_color);
+        find_uniform(fog_start);
+        find_uniform(fog_end);
+    }
 
-    // Load Shader
-    GLuint program = get_shader();
-    real_glUseProgram()(program);
+    // Nothing Has Been Uploaded Yet
+    program->uploaded.projection_model_view.projection = 0;
+    program->uploaded.projection_model_view.model_view = 0;
+    program->uploaded.model_view = 0;
+    program->uploaded.texture = 0;
+    program->uploaded.color = 0;
+    program->uploaded.fog = 0;
+
+    // Texture Unit Never Changes
+    real_glUseProgram()(program->id);
+    current_program = program->id;
+    real_glUniform1i()(program->uniforms.texture_unit, 0);
+    program->ready = 1;
+    compiling_programs.size--;
+}
+// Only Used With GL_KHR_parallel_shader_compile, Where Checking The Link Status Would Wait For The Compiler
+#define REAL_GL_COMPLETION_STATUS_KHR 0x91b1
+void poll_programs() {
+    if (!compiling_programs.parallel) {
+        return;
+    }
+    for (int i = 0; i < PROGRAM_VARIANTS && compiling_programs.size > 0; i++) {
+        program_t *program = &programs[i];
+        if (program->id != 0 && !program->ready) {
+            GLint is_complete = 0;
+            real_glGetProgramiv()(program->id, REAL_GL_COMPLETION_STATUS_KHR, &is_complete);
+            if (is_complete) {
+                finish_program(program, i);
+            }
+        }
+    }
+}
+static program_t *get_program(const int features) {
+    program_t *program = &programs[features];
+    if (!program->ready) {
+        start_program(features);
+        // Only Wait If This Program Is Still Compiling
+        poll_programs();
+        if (!program->ready) {
+            finish_program(program, features);
+        }
+    }
+    if (current_program != program->id) {
+        real_glUseProgram()(program->id);
+        current_program = program->id;
+    }
+    return program;
 }
 
-// Array Pointer Drawing
-#define lazy_handle(function, name) \
-    static GLint name##_handle = -1; \
-    if (name##_handle == -1) { \
-        mark_for_reset(&name##_handle); \
-        name##_handle = real_##function()(program, #name); \
-        if (name##_handle == -1) { \
-            ERR("Unable To Find: %s", #name); \
-        } \
-    }
-#define lazy_uniform(name) lazy_handle(glGetUniformLocation, name)
-#define lazy_attrib(name) lazy_handle(glGetAttribLocation, name)
-static void draw(void (*func)(const void *), const void *data) {
-    // Verify
-    if (gl_state.array_pointers.vertex.size != 3 || !gl_state.array_pointers.vertex.enabled || gl_state.array_pointers.vertex.type != GL_FLOAT) {
-        ERR("Unsupported Vertex Conifguration");
+// Parallel Shader Compilation
+// When The Driver Compiles On Its Own Threads, Commonly Used Variants Are Started Up Front And Polled Until They Are Done
+#define REAL_GL_MAX_SHADER_COMPILER_THREADS_KHR 0xffffffff
+static const int prewarmed_programs[] = {
+    0,
+    PROGRAM_TEXTURE,
+    PROGRAM_COLOR_ARRAY,
+    PROGRAM_TEXTURE | PROGRAM_COLOR_ARRAY
+};
+static void start_programs(const char *extensions) {
+    if (extensions != NULL && strstr(extensions, "GL_KHR_parallel_shader_compile") != NULL && HAS_GL_FUNC(glMaxShaderCompilerThreadsKHR)) {
+        real_glMaxShaderCompilerThreadsKHR()(REAL_GL_MAX_SHADER_COMPILER_THREADS_KHR);
+        compiling_programs.parallel = 1;
+        for (unsigned int i = 0; i < sizeof (prewarmed_programs) / sizeof (prewarmed_programs[0]); i++) {
+            start_program(prewarmed_programs[i]);
+        }
+    } else {
+        start_program(0);
     }
+}
 
-    // Check
-    GLint current_buffer;
-    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &current_buffer);
-    if (current_buffer == 0) {
+// Combined Projection/Model View Matrix
+// Only Recalculated When Either Stack Changes
+#define projection_model_view_cache (current_context->draw.projection_model_view_cache)
+static matrix_t *get_projection_model_view() {
+    matrix_stack_t *projection = &gl_state.matrix_stacks.projection;
+    matrix_stack_t *model_view = &gl_state.matrix_stacks.model_view;
+    if (projection_model_view_cache.projection != projection->generation || projection_model_view_cache.model_view != model_view->generation) {
+        const matrix_slot_t *projection_top = MATRIX_STACK_TOP(projection);
+        const matrix_slot_t *model_view_top = MATRIX_STACK_TOP(model_view);
+        multiply_typed_matrices(&projection_model_view_cache.matrix, &projection_top->matrix, projection_top->type, &model_view_top->matrix, model_view_top->type);
+        projection_model_view_cache.projection = projection->generation;
+        projection_model_view_cache.model_view = model_view->generation;
+    }
+    return &projection_model_view_cache.matrix;
+}
+
+// OpenGL ES 3.0 Or Newer
+static int is_es3(const char *version) {
+    return version != NULL && strncmp(version, "OpenGL ES ", 10) == 0 && version[10] >= '3';
+}
+
+// Uniform Buffer (ES 3.0)
+#define REAL_GL_UNIFORM_BUFFER 0x8a11
+#define REAL_GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 0x8a34
+#define REAL_GL_STREAM_DRAW 0x88e0
+#define UNIFORM_BUFFER_SIZE (64 * 1024)
+static void init_uniform_buffer(const char *version) {
+#ifndef GLES_COMPATIBILITY_LAYER_NO_ES3
+    uniform_buffer.enabled = is_es3(version) && HAS_GL_FUNC(glBindBufferRange) && HAS_GL_FUNC(glGetUniformBlockIndex) && HAS_GL_FUNC(glUniformBlockBinding);
+#else
+    (void) version;
+    uniform_buffer.enabled = 0;
+#endif
+    if (uniform_buffer.enabled) {
+        real_glGetIntegerv()(REAL_GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_buffer.alignment);
+        if (uniform_buffer.alignment < 1) {
+            uniform_buffer.alignment = 1;
+        }
+        // Allocated On First Write
+        uniform_buffer.offset = UNIFORM_BUFFER_SIZE;
+    }
+}
+static void update_uniform_buffer() {
+    // Check Generations
+    const matrix_stacks_t *stacks = &gl_state.matrix_stacks;
+    if (uniform_buffer.written.valid && uniform_buffer.written.projection == stacks->projection.generation && uniform_buffer.written.model_view == stacks->model_view.generation && uniform_buffer.written.texture == stacks->texture.generation && uniform_buffer.written.color == gl_state.generation.color && uniform_buffer.written.fog == gl_state.generation.fog) {
         return;
     }
 
-    // Check Mode
-    const int use_color_pointer = gl_state.array_pointers.color.enabled;
-    if (use_color_pointer && (gl_state.array_pointers.color.size != 4 || gl_state.array_pointers.color.type != GL_UNSIGNED_BYTE)) {
-        ERR("Unsupported Color Configuration");
+    // Pack
+    uniform_block_t block;
+    memcpy(block.projection_model_view, get_projection_model_view()->data, MATRIX_DATA_SIZE);
+    memcpy(block.model_view, MATRIX_STACK_TOP(&stacks->model_view)->matrix.data, MATRIX_DATA_SIZE);
+    memcpy(block.texture, MATRIX_STACK_TOP(&stacks->texture)->matrix.data, MATRIX_DATA_SIZE);
+    block.color = gl_state.color;
+    block.fog_color = gl_state.fog_parameters.color;
+    block.fog_start = gl_state.fog_parameters.start;
+    block.fog_end = gl_state.fog_parameters.end;
+    block.padding[0] = block.padding[1] = 0;
+
+    // Reserve (Orphaned When Full Instead Of Waiting For Pending Draws)
+    if (uniform_buffer.buffer == 0) {
+        real_glGenBuffers()(1, &uniform_buffer.buffer);
     }
-    const int use_texture = gl_state.texture_2d && gl_state.array_pointers.tex_coord.enabled;
-    if (use_texture && (gl_state.array_pointers.tex_coord.size != 2 || gl_state.array_pointers.tex_coord.type != GL_FLOAT)) {
-        ERR("Unsupported Texture Configuration");
+    if (!uniform_buffer.bound) {
+        real_glBindBuffer()(REAL_GL_UNIFORM_BUFFER, uniform_buffer.buffer);
+        uniform_buffer.bound = 1;
+    }
+    if (uniform_buffer.offset + (GLintptr) sizeof (uniform_block_t) > UNIFORM_BUFFER_SIZE) {
+        real_glBufferData()(REAL_GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE, NULL, REAL_GL_STREAM_DRAW);
+        uniform_buffer.offset = 0;
     }
 
-    // Get Shader
-    const GLuint program = get_shader();
+    // Upload And Bind
+    real_glBufferSubData()(REAL_GL_UNIFORM_BUFFER, uniform_buffer.offset, sizeof (uniform_block_t), &block);
+    real_glBindBufferRange()(REAL_GL_UNIFORM_BUFFER, UNIFORM_BUFFER_BINDING, uniform_buffer.buffer, uniform_buffer.offset, sizeof (uniform_block_t));
+    const GLintptr alignment = uniform_buffer.alignment;
+    uniform_buffer.offset += ((sizeof (uniform_block_t) + alignment - 1) / alignment) * alignment;
+
+    // Record Generations
+    uniform_buffer.written.valid = 1;
+    uniform_buffer.written.projection = stacks->projection.generation;
+    uniform_buffer.written.model_view = stacks->model_view.generation;
+    uniform_buffer.written.texture = stacks->texture.generation;
+    uniform_buffer.written.color = gl_state.generation.color;
+    uniform_buffer.written.fog = gl_state.generation.fog;
+}
+
+// Deferred Draws
+#define deferred_draws (current_context->draw.deferred_draws)
+
+// Vertex Array Objects
+#define vertex_arrays (current_context->draw.vertex_arrays)
+#define VERTEX_ARRAYS_NONE 0
+#define VERTEX_ARRAYS_OES 1
+#define VERTEX_ARRAYS_CORE 2
+static void init_vertex_arrays(const char *extensions, const char *version) {
+    if (is_es3(version) && HAS_GL_FUNC(glGenVertexArrays) && HAS_GL_FUNC(glBindVertexArray) && HAS_GL_FUNC(glDeleteVertexArrays)) {
+        vertex_arrays.support = VERTEX_ARRAYS_CORE;
+    } else if (extensions != NULL && strstr(extensions, "GL_OES_vertex_array_object") != NULL && HAS_GL_FUNC(glGenVertexArraysOES) && HAS_GL_FUNC(glBindVertexArrayOES) && HAS_GL_FUNC(glDeleteVertexArraysOES)) {
+        vertex_arrays.support = VERTEX_ARRAYS_OES;
+    } else {
+        vertex_arrays.support = VERTEX_ARRAYS_NONE;
+    }
+    // A Previous Context May Have Left Attributes Enabled Or Its Own VAO Bound
+    vertex_arrays.default_array.known = 0;
+    vertex_arrays.bound = NULL;
+    vertex_arrays.buffer_deletions = current_context->share_group->buffer_deletions;
+}
+static void bind_vertex_array(vertex_array_object_t *array) {
+    if (vertex_arrays.bound == array) {
+        return;
+    }
+    if (vertex_arrays.support == VERTEX_ARRAYS_CORE) {
+        real_glBindVertexArray()(array->id);
+    } else {
+        real_glBindVertexArrayOES()(array->id);
+    }
+    vertex_arrays.bound = array;
+}
+static void delete_vertex_array(vertex_array_object_t *array) {
+    if (vertex_arrays.bound == array) {
+        bind_vertex_array(&vertex_arrays.default_array);
+    }
+    if (vertex_arrays.support == VERTEX_ARRAYS_CORE) {
+        real_glDeleteVertexArrays()(1, &array->id);
+    } else {
+        real_glDeleteVertexArraysOES()(1, &array->id);
+    }
+    memset(array, 0, sizeof (vertex_array_object_t));
+}
+static int is_layer_vertex_array_bound() {
+    return vertex_arrays.bound != NULL && vertex_arrays.bound != &vertex_arrays.default_array;
+}
+// Called Before Anything That Reads Or Changes The Application's Element Array Buffer Binding
+void unbind_vertex_array_object() {
+    if (vertex_arrays.support != VERTEX_ARRAYS_NONE && vertex_arrays.bound != &vertex_arrays.default_array) {
+        bind_vertex_array(&vertex_arrays.default_array);
+    }
+}
+// Deleted Names May Be Reused, So VAOs Referencing Them Are Dropped
+static int uses_buffer(const vertex_array_object_t *array, const GLuint buffer) {
+    if (array->element_array_buffer == buffer) {
+        return 1;
+    }
+    for (int i = 0; i < VERTEX_ATTRIBS; i++) {
+        if ((array->layout.enabled & (1 << i)) && array->layout.attribs[i].buffer == buffer) {
+            return 1;
+        }
+    }
+    return 0;
+}
+static void delete_vertex_arrays() {
+    if (vertex_arrays.stream.id != 0) {
+        delete_vertex_array(&vertex_arrays.stream);
+    }
+    for (int i = 0; i < VERTEX_ARRAY_CACHE_SIZE; i++) {
+        if (vertex_arrays.cache[i].id != 0) {
+            delete_vertex_array(&vertex_arrays.cache[i]);
+        }
+    }
+}
+void delete_vertex_array_buffers(const GLsizei n, const GLuint *buffers) {
+    unbind_vertex_array_object();
+    lock_share_group();
+    const unsigned int buffer_deletions = ++current_context->share_group->buffer_deletions;
+    unlock_share_group();
+    if (vertex_arrays.buffer_deletions + 1 != buffer_deletions) {
+        // Another Context Deleted Buffers First
+        delete_vertex_arrays();
+    }
+    vertex_arrays.buffer_deletions = buffer_deletions;
+    for (GLsizei i = 0; i < n; i++) {
+        if (buffers[i] == 0) {
+            continue;
+        }
+        // Deleting A Buffer Also Detaches It From VAO 0's Attributes
+        if (uses_buffer(&vertex_arrays.default_array, buffers[i])) {
+            vertex_arrays.default_array.known = 0;
+        }
+        if (vertex_arrays.stream.id != 0 && uses_buffer(&vertex_arrays.stream, buffers[i])) {
+            delete_vertex_array(&vertex_arrays.stream);
+        }
+        for (int j = 0; j < VERTEX_ARRAY_CACHE_SIZE; j++) {
+            if (vertex_arrays.cache[j].id != 0 && uses_buffer(&vertex_arrays.cache[j], buffers[i])) {
+                delete_vertex_array(&vertex_arrays.cache[j]);
+            }
+        }
+    }
+}
+// Only Re-Specify What Differs From The VAO's Current Layout
+static void apply_vertex_layout(vertex_array_object_t *array, const vertex_layout_t *layout) {
+    for (GLuint i = 0; i < VERTEX_ATTRIBS; i++) {
+        const unsigned int bit = 1 << i;
+        const int was_enabled = array->known && (array->layout.enabled & bit);
+        if (layout->enabled & bit) {
+            const vertex_attrib_t *attrib = &layout->attribs[i];
+            if (!was_enabled || memcmp(attrib, &array->layout.attribs[i], sizeof (vertex_attrib_t)) != 0) {
+                glBindBuffer(GL_ARRAY_BUFFER, attrib->buffer);
+                real_glVertexAttribPointer()(i, attrib->size, attrib->type, attrib->normalized, attrib->stride, attrib->pointer);
+            }
+            if (!was_enabled) {
+                real_glEnableVertexAttribArray()(i);
+            }
+        } else if (was_enabled || !array->known) {
+            real_glDisableVertexAttribArray()(i);
+        }
+    }
+    array->layout = *layout;
+    array->known = 1;
+}
+static vertex_array_object_t *find_vertex_array(const vertex_layout_t *layout) {
+    vertex_array_object_t *oldest = &vertex_arrays.cache[0];
+    for (int i = 0; i < VERTEX_ARRAY_CACHE_SIZE; i++) {
+        vertex_array_object_t *array = &vertex_arrays.cache[i];
+        if (array->id != 0 && memcmp(&array->layout, layout, sizeof (vertex_layout_t)) == 0) {
+            return array;
+        }
+        if (array->id == 0 || (oldest->id != 0 && array->last_used < oldest->last_used)) {
+            oldest = array;
+        }
+    }
+    // Evicted VAOs Are Re-Specified In Place
+    return oldest;
+}
+static void use_vertex_layout(const vertex_layout_t *layout, const int streamed) {
+    if (vertex_arrays.support == VERTEX_ARRAYS_NONE) {
+        if (!vertex_arrays.default_array.known || memcmp(&vertex_arrays.default_array.layout, layout, sizeof (vertex_layout_t)) != 0) {
+            apply_vertex_layout(&vertex_arrays.default_array, layout);
+        }
+        return;
+    }
+    if (vertex_arrays.buffer_deletions != current_context->share_group->buffer_deletions) {
+        // Buffers Were Deleted By A Sharing Context
+        delete_vertex_arrays();
+        lock_share_group();
+        vertex_arrays.buffer_deletions = current_context->share_group->buffer_deletions;
+        unlock_share_group();
+    }
+    // Repeated Draws Usually Hit The Bound VAO
+    vertex_array_object_t *bound = vertex_arrays.bound;
+    if (!streamed && is_layer_vertex_array_bound() && bound != &vertex_arrays.stream && memcmp(&bound->layout, layout, sizeof (vertex_layout_t)) == 0) {
+        bound->last_used = ++vertex_arrays.clock;
+        return;
+    }
+    vertex_array_object_t *array = streamed ? &vertex_arrays.stream : find_vertex_array(layout);
+    if (array->id == 0) {
+        if (vertex_arrays.support == VERTEX_ARRAYS_CORE) {
+            real_glGenVertexArrays()(1, &array->id);
+        } else {
+            real_glGenVertexArraysOES()(1, &array->id);
+        }
+        // New VAOs Have Every Attribute Disabled
+        memset(&array->layout, 0, sizeof (vertex_layout_t));
+        array->known = 1;
+        array->element_array_buffer = 0;
+    }
+    bind_vertex_array(array);
+    array->last_used = ++vertex_arrays.clock;
+    if (memcmp(&array->layout, layout, sizeof (vertex_layout_t)) != 0) {
+        apply_vertex_layout(array, layout);
+    }
+}
+// The Element Array Buffer Is Part Of The Bound VAO
+static void bind_element_array_buffer(const GLuint buffer) {
+    if (is_layer_vertex_array_bound()) {
+        vertex_array_object_t *array = vertex_arrays.bound;
+        if (array->element_array_buffer != buffer) {
+            real_glBindBuffer()(GL_ELEMENT_ARRAY_BUFFER, buffer);
+            array->element_array_buffer = buffer;
+        }
+    } else {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+    }
+}
+
+// Init
+void _init_gles_compatibility_layer_draw() {
+    // Program Binary Cache (Keyed By Driver)
+    const char *extensions = (const char *) real_glGetString()(REAL_GL_EXTENSIONS);
+    const char *renderer = (const char *) real_glGetString()(REAL_GL_RENDERER);
+    const char *version = (const char *) real_glGetString()(REAL_GL_VERSION);
+    _init_gles_compatibility_layer_program_cache(extensions, renderer, version);
+
+    // Uniform Buffer (Decides Which Shaders Are Used)
+    init_uniform_buffer(version);
+
+    // Start Compiling Shaders (Checked When First Drawn With)
+    start_programs(extensions);
+
+    // Vertex Array Objects
+    init_vertex_arrays(extensions, version);
+}
+void _free_gles_compatibility_layer_draw() {
+    // Programs And VAOs Are Destroyed With The Real Context
+    free(deferred_draws.first);
+    free(deferred_draws.count);
+}
+void invalidate_gles_compatibility_layer_state() {
+    gl_state.server.known = 0;
+    gl_state.server.caps_known = 0;
+    current_program = 0;
+    vertex_arrays.bound = NULL;
+    vertex_arrays.default_array.known = 0;
+    uniform_buffer.bound = 0;
+    uniform_buffer.written.valid = 0;
+}
+
+// Vertex Arrays
+typedef struct {
+    GLuint index;
+    const array_pointer_t *array;
+    GLboolean normalized;
+} vertex_array_t;
+#define MAX_VERTEX_ARRAYS 3
+GLsizei get_type_size(GLenum type) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE: {
+            return 1;
+        }
+        case GL_SHORT: {
+            return 2;
+        }
+        case GL_FIXED:
+        case GL_FLOAT: {
+            return 4;
+        }
+        default: {
+            ERR("Unsupported Type: %i", type);
+        }
+    }
+}
 
-    // Projection Matrix
-    lazy_uniform(u_projection);
-    matrix_t *projection = &gl_state.matrix_stacks.projection.stack[gl_state.matrix_stacks.projection.i];
-    real_glUniformMatrix4fv()(u_projection_handle, 1, 0, (GLfloat *) &projection->data[0][0]);
+// Supported Array Formats
+// These Are Passed Directly To glVertexAttribPointer, Missing Components Default To (0, 0, 0, 1)
+static int is_coordinate_type(const GLenum type) {
+    return type == GL_BYTE || type == GL_SHORT || type == GL_FIXED || type == GL_FLOAT;
+}
+int is_supported_vertex_array(const array_pointer_t *array) {
+    return array->size >= 2 && array->size <= 4 && is_coordinate_type(array->type);
+}
+int is_supported_color_array(const array_pointer_t *array) {
+    return array->size == 4 && (array->type == GL_UNSIGNED_BYTE || array->type == GL_FIXED || array->type == GL_FLOAT);
+}
+int is_supported_tex_coord_array(const array_pointer_t *array) {
+    return array->size >= 2 && array->size <= 4 && is_coordinate_type(array->type);
+}
+static GLsizei get_stride(const array_pointer_t *array) {
+    return array->stride != 0 ? array->stride : array->size * get_type_size(array->type);
+}
+
+// Client-Side Array Streaming
+#define stream_indices (current_context->draw.stream_indices)
+// Interleaved Arrays Overlap, So They Are Merged Into One Span And Uploaded Once
+typedef struct {
+    const unsigned char *start;
+    const unsigned char *end;
+    GLintptr offset;
+} span_t;
+static int add_span(span_t *spans, int spans_size, const unsigned char *start, const unsigned char *end) {
+    // Merge Overlapping Spans
+    for (int i = 0; i < spans_size; i++) {
+        if (start <= spans[i].end && end >= spans[i].start) {
+            start = start < spans[i].start ? start : spans[i].start;
+            end = end > spans[i].end ? end : spans[i].end;
+            spans[i] = spans[--spans_size];
+            i = -1;
+        }
+    }
+    spans[spans_size].start = start;
+    spans[spans_size].end = end;
+    return spans_size + 1;
+}
+static GLint setup_vertex_arrays(const vertex_array_t *arrays, const int arrays_size, const GLint first, const GLsizei count) {
+    // Find Client-Side Data
+    span_t spans[MAX_VERTEX_ARRAYS];
+    int spans_size = 0;
+    for (int i = 0; i < arrays_size; i++) {
+        const array_pointer_t *array = arrays[i].array;
+        if (array->buffer == 0) {
+            const GLsizei stride = get_stride(array);
+            const unsigned char *start = ((const unsigned char *) array->pointer) + (first * stride);
+            const unsigned char *end = start + ((count - 1) * stride) + (array->size * get_type_size(array->type));
+            spans_size = add_span(spans, spans_size, start, end);
+        }
+    }
 
-    // Model View Matrix
-    lazy_uniform(u_model_view);
-    matrix_t *model_view = &gl_state.matrix_stacks.model_view.stack[gl_state.matrix_stacks.model_view.i];
-    real_glUniformMatrix4fv()(u_model_view_handle, 1, 0, (GLfloat *) &model_view->data[0][0]);
+    // Stream Data
+    // When Streaming, The Referenced Range Starts At Vertex 0
+    GLint base = 0;
+    stream_indices.offset = -1;
+    if (spans_size > 0) {
+        GLsizeiptr total_size = 0;
+        for (int i = 0; i < spans_size; i++) {
+            total_size += STREAM_ALIGN(spans[i].end - spans[i].start);
+        }
+        GLintptr offset = stream_reserve(total_size + stream_indices.size);
+        for (int i = 0; i < spans_size; i++) {
+            spans[i].offset = offset;
+            glBufferSubData(GL_ARRAY_BUFFER, offset, spans[i].end - spans[i].start, spans[i].start);
+            offset += STREAM_ALIGN(spans[i].end - spans[i].start);
+        }
+        if (stream_indices.size > 0) {
+            stream_indices.offset = offset;
+        }
+        base = first;
+    }
 
-    // Has Texture
-    lazy_uniform(u_has_texture);
-    real_glUniform1i()(u_has_texture_handle, use_texture);
+    // Setup Attributes
+    vertex_layout_t layout;
+    memset(&layout, 0, sizeof (vertex_layout_t));
+    for (int i = 0; i < arrays_size; i++) {
+        const array_pointer_t *array = arrays[i].array;
+        const unsigned char *pointer = array->pointer;
+        GLuint buffer = array->buffer;
+        if (array->buffer == 0) {
+            const unsigned char *start = pointer + (first * get_stride(array));
+            for (int j = 0; j < spans_size; j++) {
+                if (start >= spans[j].start && start < spans[j].end) {
+                    pointer = (const unsigned char *) (spans[j].offset + (start - spans[j].start));
+                    break;
+                }
+            }
+            buffer = get_stream_buffer();
+        } else {
+            pointer += base * get_stride(array);
+        }
+        vertex_attrib_t *attrib = &layout.attribs[arrays[i].index];
+        attrib->buffer = buffer;
+        attrib->pointer = pointer;
+        attrib->size = array->size;
+        attrib->type = array->type;
+        attrib->normalized = arrays[i].normalized;
+        attrib->stride = array->stride;
+        layout.enabled |= 1 << arrays[i].index;
+    }
+    use_vertex_layout(&layout, spans_size > 0);
 
-    // Texture Matrix
-    lazy_uniform(u_texture);
-    matrix_t *texture = &gl_state.matrix_stacks.texture.stack[gl_state.matrix_stacks.texture.i];
-    real_glUniformMatrix4fv()(u_texture_handle, 1, 0, (GLfloat *) &texture->data[0][0]);
+    // Return
+    return base;
+}
 
-    // Texture Unit
-    lazy_uniform(u_texture_unit);
-    real_glUniform1i()(u_texture_unit_handle, 0);
+// Array Pointer Drawing
+#define upload_if_changed(name, value, upload) \
+    if (program->uploaded.name != (value)) { \
+        upload; \
+        program->uploaded.name = (value); \
+    }
+// Individual Uniforms (ES 2.0)
+static void upload_uniforms(program_t *program, const int use_color_pointer, const int use_texture_matrix) {
+    // Projection/Model View Matrix
+    if (program->uploaded.projection_model_view.projection != gl_state.matrix_stacks.projection.generation || program->uploaded.projection_model_view.model_view != gl_state.matrix_stacks.model_view.generation) {
+        matrix_t *matrix = get_projection_model_view();
+        real_glUniformMatrix4fv()(program->uniforms.projection_model_view, 1, 0, (GLfloat *) &matrix->data[0][0]);
+        program->uploaded.projection_model_view.projection = gl_state.matrix_stacks.projection.generation;
+        program->uploaded.projection_model_view.model_view = gl_state.matrix_stacks.model_view.generation;
+    }
 
-    // Alpha Test
-    lazy_uniform(u_alpha_test);
-    real_glUniform1i()(u_alpha_test_handle, gl_state.alpha_test);
+    // Texture Matrix (Skipped When Identity)
+    if (use_texture_matrix) {
+        upload_if_changed(texture, gl_state.matrix_stacks.texture.generation, {
+            const matrix_t *texture = &MATRIX_STACK_TOP(&gl_state.matrix_stacks.texture)->matrix;
+            real_glUniformMatrix4fv()(program->uniforms.texture, 1, 0, (GLfloat *) &texture->data[0][0]);
+        });
+    }
 
     // Color
-    lazy_attrib(a_color);
-    if (use_color_pointer) {
-        real_glVertexAttribPointer()(a_color_handle, gl_state.array_pointers.color.size, gl_state.array_pointers.color.type, 1, gl_state.array_pointers.color.stride, gl_state.array_pointers.color.pointer);
-        real_glEnableVertexAttribArray()(a_color_handle);
-    } else {
-        real_glVertexAttrib4f()(a_color_handle, gl_state.color.red, gl_state.color.green, gl_state.color.blue, gl_state.color.alpha);
+    if (!use_color_pointer) {
+        upload_if_changed(color, gl_state.generation.color, real_glUniform4f()(program->uniforms.color, gl_state.color.red, gl_state.color.green, gl_state.color.blue, gl_state.color.alpha));
     }
 
     // Fog
-    lazy_uniform(u_fog);
-    real_glUniform1i()(u_fog_handle, gl_state.fog.enabled);
     if (gl_state.fog.enabled) {
-        lazy_uniform(u_fog_color);
-        real_glUniform4f()(u_fog_color_handle, gl_state.fog.color.red, gl_state.fog.color.green, gl_state.fog.color.blue, gl_state.fog.color.alpha);
-        lazy_uniform(u_fog_is_linear);
-        real_glUniform1i()(u_fog_is_linear_handle, gl_state.fog.mode == GL_LINEAR);
-        lazy_uniform(u_fog_start);
-        real_glUniform1f()(u_fog_start_handle, gl_state.fog.start);
-        lazy_uniform(u_fog_end);
-        real_glUniform1f()(u_fog_end_handle, gl_state.fog.end);
-    }
-
-    // Vertices
-    lazy_attrib(a_vertex_coords);
-    real_glVertexAttribPointer()(a_vertex_coords_handle, gl_state.array_pointers.vertex.size, gl_state.array_pointers.vertex.type, 0, gl_state.array_pointers.vertex.stride, gl_state.array_pointers.vertex.pointer);
-    real_glEnableVertexAttribArray()(a_vertex_coords_handle);
-
-    // Texture Coordinates
-    lazy_attrib(a_texture_coords);
+        // Model View Matrix (Only Needed For Fog)
+        upload_if_changed(model_view, gl_state.matrix_stacks.model_view.generation, {
+            const matrix_t *model_view = &MATRIX_STACK_TOP(&gl_state.matrix_stacks.model_view)->matrix;
+            real_glUniformMatrix4fv()(program->uniforms.model_view, 1, 0, (GLfloat *) &model_view->data[0][0]);
+        });
+
+        // Parameters
+        upload_if_changed(fog, gl_state.generation.fog, {
+            real_glUniform4f()(program->uniforms.fog_color, gl_state.fog_parameters.color.red, gl_state.fog_parameters.color.green, gl_state.fog_parameters.color.blue, gl_state.fog_parameters.color.alpha);
+            real_glUniform1f()(program->uniforms.fog_start, gl_state.fog_parameters.start);
+            real_glUniform1f()(program->uniforms.fog_end, gl_state.fog_parameters.end);
+        });
+    }
+}
+static void draw_arrays(const array_pointer_t *vertex, const array_pointer_t *color, const array_pointer_t *tex_coord, void (*func)(const void *, GLint), const void *data, const GLint first, const GLsizei count) {
+    INSTRUMENT_INTERNAL();
+    // Check Mode
+    const int use_color_pointer = color != NULL;
+    const int use_texture = tex_coord != NULL;
+
+    // Staged Texture Updates
     if (use_texture) {
-        real_glVertexAttribPointer()(a_texture_coords_handle, gl_state.array_pointers.tex_coord.size, gl_state.array_pointers.tex_coord.type, 0, gl_state.array_pointers.tex_coord.stride, gl_state.array_pointers.tex_coord.pointer);
-        real_glEnableVertexAttribArray()(a_texture_coords_handle);
-    } else {
-        real_glVertexAttrib3f()(a_texture_coords_handle, 0, 0, 0);
+        FLUSH_TEXTURE_UPLOADS();
     }
 
-    // Draw
-    func(data);
+    // Get Shader
+    int features = 0;
+    const matrix_stack_t *texture_stack = &gl_state.matrix_stacks.texture;
+    const int use_texture_matrix = use_texture && MATRIX_STACK_TOP(texture_stack)->type != MATRIX_TYPE_IDENTITY;
+    if (use_texture) {
+        features |= PROGRAM_TEXTURE;
+    }
+    if (use_texture_matrix) {
+        features |= PROGRAM_TEXTURE_MATRIX;
+    }
+    if (use_color_pointer) {
+        features |= PROGRAM_COLOR_ARRAY;
+    }
+    if (gl_state.alpha_test) {
+        features |= PROGRAM_ALPHA_TEST;
+    }
+    if (gl_state.fog.enabled) {
+        features |= gl_state.fog.mode == GL_LINEAR ? PROGRAM_FOG_LINEAR : PROGRAM_FOG_EXP;
+    }
+    program_t *program = get_program(features);
+
+    // Uniforms
+    if (uniform_buffer.enabled) {
+        update_uniform_buffer();
+    } else {
+        upload_uniforms(program, use_color_pointer, use_texture_matrix);
+    }
 
-    // Cleanup
+    // Vertex Arrays
+    vertex_array_t arrays[MAX_VERTEX_ARRAYS];
+    int arrays_size = 0;
+    arrays[arrays_size++] = (vertex_array_t) {ATTRIB_VERTEX_COORDS, vertex, 0};
     if (use_color_pointer) {
-        real_glDisableVertexAttribArray()(a_color_handle);
+        // Only Integer Colors Are Normalized
+        arrays[arrays_size++] = (vertex_array_t) {ATTRIB_COLOR, color, color->type == GL_UNSIGNED_BYTE};
     }
-    real_glDisableVertexAttribArray()(a_vertex_coords_handle);
     if (use_texture) {
-        real_glDisableVertexAttribArray()(a_texture_coords_handle);
+        arrays[arrays_size++] = (vertex_array_t) {ATTRIB_TEXTURE_COORDS, tex_coord, 0};
+    }
+    GLint current_buffer;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &current_buffer);
+    const GLint base = setup_vertex_arrays(arrays, arrays_size, first, count);
+    glBindBuffer(GL_ARRAY_BUFFER, current_buffer);
+
+    // Draw (Attributes Stay Enabled Until A Draw Needs A Different Set)
+    func(data, base);
+}
+static void draw(void (*func)(const void *, GLint), const void *data, const GLint first, const GLsizei count) {
+    // Verify
+    if (!gl_state.array_pointers.vertex.enabled || !is_supported_vertex_array(&gl_state.array_pointers.vertex)) {
+        ERR("Unsupported Vertex Conifguration");
+    }
+
+    // Check
+    if (count <= 0) {
+        return;
+    }
+
+    // Check Mode
+    const int use_color_pointer = gl_state.array_pointers.color.enabled;
+    if (use_color_pointer && !is_supported_color_array(&gl_state.array_pointers.color)) {
+        ERR("Unsupported Color Configuration");
+    }
+    const int use_texture = gl_state.texture_2d && gl_state.array_pointers.tex_coord.enabled;
+    if (use_texture && !is_supported_tex_coord_array(&gl_state.array_pointers.tex_coord)) {
+        ERR("Unsupported Texture Configuration");
+    }
+
+    // Draw
+    draw_arrays(&gl_state.array_pointers.vertex, use_color_pointer ? &gl_state.array_pointers.color : NULL, use_texture ? &gl_state.array_pointers.tex_coord : NULL, func, data, first, count);
+}
+
+// Find The Range Of Vertices Referenced By Multiple Draws
+static void get_range(const GLint *first, const GLsizei *count, const GLsizei drawcount, GLint *range_start, GLsizei *range_count) {
+    int has_range = 0;
+    GLint start = 0;
+    GLint end = 0;
+    for (GLsizei i = 0; i < drawcount; i++) {
+        if (count[i] <= 0) {
+            continue;
+        }
+        if (!has_range || first[i] < start) {
+            start = first[i];
+        }
+        if (!has_range || first[i] + count[i] > end) {
+            end = first[i] + count[i];
+        }
+        has_range = 1;
+    }
+    *range_start = start;
+    *range_count = end - start;
+}
+
+// Deferred Draws
+// Consecutive Draws Are Queued Until Something Changes, Then Submitted As One
+static int uses_client_arrays() {
+    if (gl_state.array_pointers.vertex.buffer == 0) {
+        return 1;
+    }
+    if (gl_state.array_pointers.color.enabled && gl_state.array_pointers.color.buffer == 0) {
+        return 1;
+    }
+    if (gl_state.texture_2d && gl_state.array_pointers.tex_coord.enabled && gl_state.array_pointers.tex_coord.buffer == 0) {
+        return 1;
+    }
+    return 0;
+}
+static int defer_draws(const GLenum mode, const GLint *first, const GLsizei *count, const GLsizei drawcount) {
+    if (pending_immediate_size > 0) {
+        flush_immediate();
+    }
+    // Client-Side Data May Change After Returning, So It Is Never Deferred
+    if (!deferred_draws.enabled || uses_client_arrays()) {
+        FLUSH_DRAWS();
+        return 0;
+    }
+    if (deferred_draws.mode != mode) {
+        FLUSH_DRAWS();
+        deferred_draws.mode = mode;
     }
+
+    // Queue
+    const GLsizei primitive_size = mode == GL_TRIANGLES ? 3 : (mode == GL_LINES ? 2 : 0);
+    for (GLsizei i = 0; i < drawcount; i++) {
+        if (count[i] <= 0) {
+            continue;
+        }
+        if (pending_draws_size > 0) {
+            // Extend Contiguous Ranges (Only After Whole Primitives, Leftover Vertices Are Dropped By The Driver)
+            GLsizei last = pending_draws_size - 1;
+            if (primitive_size > 0 && deferred_draws.count[last] % primitive_size == 0 && deferred_draws.first[last] + deferred_draws.count[last] == first[i]) {
+                deferred_draws.count[last] += count[i];
+                continue;
+            }
+            // Separate Ranges Need glMultiDrawArraysEXT
+            if (!deferred_draws.has_multi_draw) {
+                FLUSH_DRAWS();
+            }
+        }
+        if (pending_draws_size >= deferred_draws.capacity) {
+            deferred_draws.capacity = deferred_draws.capacity > 0 ? deferred_draws.capacity * 2 : 64;
+            deferred_draws.first = realloc(deferred_draws.first, deferred_draws.capacity * sizeof (GLint));
+            ALLOC_CHECK(deferred_draws.first);
+            deferred_draws.count = realloc(deferred_draws.count, deferred_draws.capacity * sizeof (GLsizei));
+            ALLOC_CHECK(deferred_draws.count);
+        }
+        deferred_draws.first[pending_draws_size] = first[i];
+        deferred_draws.count[pending_draws_size] = count[i];
+        pending_draws_size++;
+    }
+    return 1;
+}
+int are_draws_deferred() {
+    return deferred_draws.enabled;
+}
+void set_gles_compatibility_layer_deferred_draws(const GLboolean enabled) {
+    FLUSH_DRAWS();
+    deferred_draws.enabled = enabled;
+    const char *extensions = (const char *) real_glGetString()(REAL_GL_EXTENSIONS);
+    deferred_draws.has_multi_draw = extensions != NULL && strstr(extensions, "GL_EXT_multi_draw_arrays") != NULL && HAS_GL_FUNC(glMultiDrawArraysEXT);
 }
 
 // glDrawArrays
@@ -251,18 +977,131 @@ struct cmd_glDrawArrays {
     GLint first;
     GLsizei count;
 };
-GL_FUNC(glDrawArrays, void, (GLenum mode, GLint first, GLsizei count));
-static void do_glDrawArrays(const void *data) {
+GL_FUNC(glDrawArrays, void, ((GLenum, mode), (GLint, first), (GLsizei, count)));
+static void do_glDrawArrays(const void *data, const GLint base) {
     const struct cmd_glDrawArrays *cmd = data;
-    real_glDrawArrays()(cmd->mode, cmd->first, cmd->count);
+    real_glDrawArrays()(cmd->mode, cmd->first - base, cmd->count);
 }
 void glDrawArrays(const GLenum mode, const GLint first, const GLsizei count) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glDrawArrays, (mode, first, count));
+    if (COMPILING_LIST()) {
+        list_draw_arrays(mode, first, count);
+        return;
+    }
+    if (defer_draws(mode, &first, &count, 1)) {
+        return;
+    }
+    const struct cmd_glDrawArrays cmd = {
+        .mode = mode,
+        .first = first,
+        .count = count
+    };
+    draw(do_glDrawArrays, &cmd, first, count);
+}
+
+// Draw Arrays That Are Not Part Of The Client State (Used By Display Lists)
+void draw_buffer(const GLenum mode, const array_pointer_t *vertex, const array_pointer_t *color, const array_pointer_t *tex_coord, const GLint first, const GLsizei count) {
     const struct cmd_glDrawArrays cmd = {
         .mode = mode,
         .first = first,
         .count = count
     };
-    draw(do_glDrawArrays, &cmd);
+    draw_arrays(vertex, color, gl_state.texture_2d ? tex_coord : NULL, do_glDrawArrays, &cmd, first, count);
+}
+
+// glDrawElements
+struct cmd_glDrawElements {
+    GLenum mode;
+    GLsizei count;
+    GLenum type;
+    const void *indices;
+    GLuint element_array_buffer;
+};
+GL_FUNC(glDrawElements, void, ((GLenum, mode), (GLsizei, count), (GLenum, type), (const void *, indices)));
+static void do_glDrawElements(const void *data, const GLint base) {
+    const struct cmd_glDrawElements *cmd = data;
+    if (cmd->element_array_buffer != 0 && base == 0) {
+        bind_element_array_buffer(cmd->element_array_buffer);
+        real_glDrawElements()(cmd->mode, cmd->count, cmd->type, cmd->indices);
+        return;
+    }
+
+    // Rebase Onto Streamed Data
+    const GLsizei index_size = get_index_size(cmd->type);
+    const GLsizeiptr size = cmd->count * index_size;
+    const void *indices = get_index_data(cmd->type, cmd->indices, cmd->count);
+    if (base != 0) {
+        static __thread unsigned char *rebased_indices = NULL;
+        static __thread GLsizeiptr rebased_indices_size = 0;
+        if (rebased_indices_size < size) {
+            rebased_indices_size = size;
+            rebased_indices = realloc(rebased_indices, rebased_indices_size);
+            ALLOC_CHECK(rebased_indices);
+        }
+        for (GLsizei i = 0; i < cmd->count; i++) {
+            const GLuint index = read_index(cmd->type, indices, i) - base;
+            if (cmd->type == GL_UNSIGNED_BYTE) {
+                rebased_indices[i] = index;
+            } else {
+                ((GLushort *) rebased_indices)[i] = index;
+            }
+        }
+        indices = rebased_indices;
+    }
+
+    // Stream Indices (Client-Side Pointers Cannot Be Used With The Submission Thread)
+    GLint current_buffer;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &current_buffer);
+    GLintptr offset = stream_indices.offset;
+    if (offset >= 0) {
+        // Reserved With The Vertices
+        glBindBuffer(GL_ARRAY_BUFFER, get_stream_buffer());
+    } else {
+        offset = stream_reserve(size);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, indices);
+    glBindBuffer(GL_ARRAY_BUFFER, current_buffer);
+    bind_element_array_buffer(get_stream_buffer());
+    real_glDrawElements()(cmd->mode, cmd->count, cmd->type, (const void *) offset);
+    // The Layer's VAOs Track Their Own Binding
+    if (!is_layer_vertex_array_bound()) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cmd->element_array_buffer);
+    }
+}
+void glDrawElements(const GLenum mode, const GLsizei count, const GLenum type, const void *indices) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glDrawElements, (mode, count, type, indices));
+    if (COMPILING_LIST()) {
+        list_draw_elements(mode, count, type, indices);
+        return;
+    }
+    // Verify Index Type
+    get_index_size(type);
+    if (count <= 0) {
+        return;
+    }
+    FLUSH_DRAWS();
+    const struct cmd_glDrawElements cmd = {
+        .mode = mode,
+        .count = count,
+        .type = type,
+        .indices = indices,
+        .element_array_buffer = get_element_array_buffer()
+    };
+    // Only The Referenced Vertices Are Streamed
+    GLint first = 0;
+    GLsizei range_count = 1;
+    if (uses_client_arrays()) {
+        GLuint min;
+        GLuint max;
+        get_index_range(type, indices, count, &min, &max);
+        first = min;
+        range_count = (max - min) + 1;
+    }
+    stream_indices.size = STREAM_ALIGN(count * get_index_size(type));
+    draw(do_glDrawElements, &cmd, first, range_count);
+    stream_indices.size = 0;
 }
 
 // glMultiDrawArrays
@@ -272,17 +1111,84 @@ struct cmd_glMultiDrawArrays {
     const GLsizei *count;
     GLsizei drawcount;
 };
-GL_FUNC(glMultiDrawArraysEXT, void, (GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount));
-static void do_glMultiDrawArrays(const void *data) {
+GL_FUNC_COPY(glMultiDrawArraysEXT, void, ((GLenum, mode), (const GLint *, first), (const GLsizei *, count), (GLsizei, drawcount)), ((first, drawcount * sizeof (GLint)), (count, drawcount * sizeof (GLsizei))));
+static void do_glMultiDrawArrays(const void *data, const GLint base) {
     const struct cmd_glMultiDrawArrays *cmd = data;
-    real_glMultiDrawArraysEXT()(cmd->mode, cmd->first, cmd->count, cmd->drawcount);
+    const GLint *first = cmd->first;
+    if (base != 0) {
+        // Rebase Onto Streamed Data
+        static __thread GLint *rebased_first = NULL;
+        static __thread GLsizei rebased_first_size = 0;
+        if (rebased_first_size < cmd->drawcount) {
+            rebased_first_size = cmd->drawcount;
+            rebased_first = realloc(rebased_first, rebased_first_size * sizeof (GLint));
+            ALLOC_CHECK(rebased_first);
+        }
+        for (GLsizei i = 0; i < cmd->drawcount; i++) {
+            rebased_first[i] = cmd->first[i] - base;
+        }
+        first = rebased_first;
+    }
+    if (HAS_GL_FUNC(glMultiDrawArraysEXT)) {
+        real_glMultiDrawArraysEXT()(cmd->mode, first, cmd->count, cmd->drawcount);
+    } else {
+        // One Draw Per Range Without GL_EXT_multi_draw_arrays
+        for (GLsizei i = 0; i < cmd->drawcount; i++) {
+            if (cmd->count[i] > 0) {
+                real_glDrawArrays()(cmd->mode, first[i], cmd->count[i]);
+            }
+        }
+    }
 }
 void glMultiDrawArrays(const GLenum mode, const GLint *first, const GLsizei *count, const GLsizei drawcount) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glMultiDrawArrays, (mode, first, count, drawcount));
+    if (COMPILING_LIST()) {
+        for (GLsizei i = 0; i < drawcount; i++) {
+            list_draw_arrays(mode, first[i], count[i]);
+        }
+        return;
+    }
+    if (defer_draws(mode, first, count, drawcount)) {
+        return;
+    }
     const struct cmd_glMultiDrawArrays cmd = {
         .mode = mode,
         .first = first,
         .count = count,
         .drawcount = drawcount
     };
-    draw(do_glMultiDrawArrays, &cmd);
-}
\ No newline at end of file
+    GLint range_start;
+    GLsizei range_count;
+    get_range(first, count, drawcount, &range_start, &range_count);
+    draw(do_glMultiDrawArrays, &cmd, range_start, range_count);
+}
+// Flush Deferred Draws
+void flush_pending_draws() {
+    INSTRUMENT_INTERNAL();
+    if (pending_immediate_size > 0) {
+        flush_immediate();
+    }
+    // Clear First, Because draw() Calls Functions That Flush
+    const GLsizei size = pending_draws_size;
+    pending_draws_size = 0;
+    if (size == 1) {
+        const struct cmd_glDrawArrays cmd = {
+            .mode = deferred_draws.mode,
+            .first = deferred_draws.first[0],
+            .count = deferred_draws.count[0]
+        };
+        draw(do_glDrawArrays, &cmd, cmd.first, cmd.count);
+    } else if (size > 1) {
+        const struct cmd_glMultiDrawArrays cmd = {
+            .mode = deferred_draws.mode,
+            .first = deferred_draws.first,
+            .count = deferred_draws.count,
+            .drawcount = size
+        };
+        GLint range_start;
+        GLsizei range_count;
+        get_range(cmd.first, cmd.count, cmd.drawcount, &range_start, &range_count);
+        draw(do_glMultiDrawArrays, &cmd, range_start, range_count);
+    }
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <GLES/gl.h>
+
+#include "state.h"
+
+// Deferred Draws
+// Must Be Flushed Before Any Change That Could Affect A Pending Draw
+// Array Draws And Immediate Mode Batches Are Never Pending At The Same Time
+#define pending_draws_size (current_context->pending.draws)
+#define pending_immediate_size (current_context->pending.immediate_size)
+void flush_pending_draws();
+int are_draws_deferred();
+#define FLUSH_DRAWS() \
+    { \
+        if (pending_draws_size > 0 || pending_immediate_size > 0) { \
+            flush_pending_draws(); \
+        } \
+    }
+
+// Immediate Mode
+// The Current Color Is Captured Per-Vertex, So Color Changes Never Split A Batch
+typedef struct {
+    GLfloat position[3];
+    GLfloat color[4];
+    GLfloat tex_coord[2];
+} immediate_vertex_t;
+// Growable Vertex Arena
+typedef struct {
+    immediate_vertex_t *vertices;
+    GLsizei size;
+    GLsizei capacity;
+} arena_t;
+typedef struct {
+    // Inside glBegin/glEnd
+    GLboolean active;
+    GLenum mode;
+    GLfloat tex_coord[2];
+    // Vertices Of The Current Block
+    arena_t block;
+    // Assembled Vertices Waiting To Be Drawn
+    arena_t batch;
+    GLenum batch_mode;
+} immediate_context_t;
+void _free_gles_compatibility_layer_immediate();
+void flush_immediate();
+
+// Draw Arrays That Are Not Part Of The Client State
+// tex_coord Is Ignored When Texturing Is Disabled
+void draw_buffer(GLenum mode, const array_pointer_t *vertex, const array_pointer_t *color, const array_pointer_t *tex_coord, GLint first, GLsizei count);
+
+// Vertex Array Formats
+GLsizei get_type_size(GLenum type);
+int is_supported_vertex_array(const array_pointer_t *array);
+int is_supported_color_array(const array_pointer_t *array);
+int is_supported_tex_coord_array(const array_pointer_t *array);
+
+// Vertex Array Objects
+// Attribute Layouts Are Cached In VAOs So A Repeated Draw Only Needs A Bind
+// The Layer's VAOs Stay Bound Between Draws, The Application's Element Array Buffer Binding Lives In VAO 0
+#define VERTEX_ATTRIBS 3
+#define VERTEX_ARRAY_CACHE_SIZE 32
+typedef struct {
+    GLuint buffer;
+    const void *pointer;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei stride;
+} vertex_attrib_t;
+typedef struct {
+    // Compared With memcmp, So Always Zeroed Before Being Filled In
+    unsigned int enabled;
+    vertex_attrib_t attribs[VERTEX_ATTRIBS];
+} vertex_layout_t;
+typedef struct {
+    GLuint id;
+    // Whether layout Matches The Real State
+    GLboolean known;
+    vertex_layout_t layout;
+    GLuint element_array_buffer;
+    unsigned int last_used;
+} vertex_array_object_t;
+void unbind_vertex_array_object();
+void delete_vertex_array_buffers(GLsizei n, const GLuint *buffers);
+
+// Uniform Buffer (ES 3.0)
+// Fixed-Function State Is Packed Into One std140 Block Shared By Every Program
+// A New Block Is Written To A Ring Buffer Only When The State Changes, Then Bound By Offset
+typedef struct {
+    GLfloat projection_model_view[MATRIX_SIZE * MATRIX_SIZE];
+    GLfloat model_view[MATRIX_SIZE * MATRIX_SIZE];
+    GLfloat texture[MATRIX_SIZE * MATRIX_SIZE];
+    color_t color;
+    color_t fog_color;
+    GLfloat fog_start;
+    GLfloat fog_end;
+    GLfloat padding[2];
+} uniform_block_t;
+
+// Shader Program Cache
+// Each Combination Of Features Gets Its Own Program With Dead Paths Compiled Out
+#define PROGRAM_TEXTURE (1 << 0)
+#define PROGRAM_COLOR_ARRAY (1 << 1)
+#define PROGRAM_ALPHA_TEST (1 << 2)
+#define PROGRAM_FOG_LINEAR (1 << 3)
+#define PROGRAM_FOG_EXP (1 << 4)
+#define PROGRAM_TEXTURE_MATRIX (1 << 5)
+#define PROGRAM_VARIANTS (1 << 6)
+typedef struct {
+    GLuint id;
+    // Compiled Asynchronously, Checked And Set Up When First Drawn With
+    GLboolean ready;
+    GLuint vertex_shader;
+    GLuint fragment_shader;
+    uint64_t cache_key;
+    // Uniform Locations
+    struct {
+        GLint projection_model_view;
+        GLint model_view;
+        GLint texture;
+        GLint texture_unit;
+        GLint color;
+        GLint fog_color;
+        GLint fog_start;
+        GLint fog_end;
+    } uniforms;
+    // Uniform Shadow Cache (Generations Last Uploaded To This Program)
+    struct {
+        struct {
+            unsigned int projection;
+            unsigned int model_view;
+        } projection_model_view;
+        unsigned int model_view;
+        unsigned int texture;
+        unsigned int color;
+        unsigned int fog;
+    } uploaded;
+} program_t;
+
+// Per-Context Draw State
+typedef struct {
+    program_t programs[PROGRAM_VARIANTS];
+    GLuint current_program;
+    // Started But Not Yet Set Up (Polled When The Driver Compiles On Its Own Threads)
+    struct {
+        GLboolean parallel;
+        int size;
+    } compiling_programs;
+    // Combined Projection/Model View Matrix (Only Recalculated When Either Stack Changes)
+    struct {
+        unsigned int projection;
+        unsigned int model_view;
+        matrix_t matrix;
+    } projection_model_view_cache;
+    struct {
+        GLboolean enabled;
+        GLboolean has_multi_draw;
+        GLenum mode;
+        GLint *first;
+        GLsizei *count;
+        GLsizei capacity;
+    } deferred_draws;
+    // Indices Streamed After The Vertices Of The Same Draw
+    // Reserved Together With Them, So Orphaning The Stream Buffer Cannot Discard The Vertices First
+    struct {
+        GLsizeiptr size;
+        // -1 When Not Reserved
+        GLintptr offset;
+    } stream_indices;
+    struct {
+        // VERTEX_ARRAYS_*
+        int support;
+        // VAO 0 (Also Used For Every Draw Without VAO Support)
+        vertex_array_object_t default_array;
+        // Layouts That Read From The Stream Buffer Change Every Draw, So They Share One VAO
+        vertex_array_object_t stream;
+        vertex_array_object_t cache[VERTEX_ARRAY_CACHE_SIZE];
+        // NULL When Unknown
+        vertex_array_object_t *bound;
+        unsigned int clock;
+        // Share Group Buffer Deletions Already Accounted For
+        unsigned int buffer_deletions;
+    } vertex_arrays;
+    struct {
+        GLboolean enabled;
+        GLuint buffer;
+        GLintptr offset;
+        GLint alignment;
+        // Whether The Buffer Is Bound To GL_UNIFORM_BUFFER
+        GLboolean bound;
+        // Generations In The Last Written Block
+        struct {
+            GLboolean valid;
+            unsigned int projection;
+            unsigned int model_view;
+            unsigned int texture;
+            unsigned int color;
+            unsigned int fog;
+        } written;
+    } uniform_buffer;
+} draw_context_t;
+// Starts Building Programs For The Current Context
+void _init_gles_compatibility_layer_draw();
+void _free_gles_compatibility_layer_draw();
+// Sets Up Programs The Driver Has Finished Compiling, Without Waiting For The Others
+void poll_programs();
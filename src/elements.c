@@ -0,0 +1,189 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "elements.h"
+#include "context.h"
+#include "log.h"
+
+// Shadowed Buffers
+#define element_buffers (current_context->share_group->elements.buffers)
+#define element_buffers_size (current_context->share_group->elements.size)
+void _free_gles_compatibility_layer_elements(element_buffers_t *elements) {
+    for (GLuint i = 0; i < elements->size; i++) {
+        free(elements->buffers[i].data);
+    }
+    free(elements->buffers);
+    elements->buffers = NULL;
+    elements->size = 0;
+}
+static element_buffer_t *get_element_buffer(const GLuint buffer) {
+    if (buffer >= element_buffers_size || element_buffers[buffer].data == NULL) {
+        return NULL;
+    }
+    return &element_buffers[buffer];
+}
+
+// Current Binding
+GLuint get_element_array_buffer() {
+    if (gl_state.server.known & SERVER_STATE_ELEMENT_ARRAY_BUFFER) {
+        return gl_state.server.element_array_buffer;
+    }
+    // Queried Once (Only glBindBuffer Changes It)
+    GLint buffer;
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &buffer);
+    gl_state.server.element_array_buffer = buffer;
+    gl_state.server.known |= SERVER_STATE_ELEMENT_ARRAY_BUFFER;
+    return buffer;
+}
+
+// Track Uploads
+void element_buffer_data(const GLuint buffer, const GLsizeiptr size, const void *data) {
+    if (buffer == 0) {
+        return;
+    }
+    lock_share_group();
+    if (buffer >= element_buffers_size) {
+        const GLuint new_size = buffer + 1;
+        element_buffers = realloc(element_buffers, new_size * sizeof (element_buffer_t));
+        ALLOC_CHECK(element_buffers);
+        memset(&element_buffers[element_buffers_size], 0, (new_size - element_buffers_size) * sizeof (element_buffer_t));
+        element_buffers_size = new_size;
+    }
+    element_buffer_t *element_buffer = &element_buffers[buffer];
+    // Allocate At Least One Byte So Empty Buffers Are Still Tracked
+    element_buffer->data = realloc(element_buffer->data, size > 0 ? size : 1);
+    ALLOC_CHECK(element_buffer->data);
+    element_buffer->size = size;
+    if (data != NULL) {
+        memcpy(element_buffer->data, data, size);
+    } else {
+        memset(element_buffer->data, 0, size);
+    }
+    element_buffer->ranges_size = 0;
+    element_buffer->next_range = 0;
+    unlock_share_group();
+}
+void element_buffer_sub_data(const GLuint buffer, const GLintptr offset, const GLsizeiptr size, const void *data) {
+    lock_share_group();
+    element_buffer_t *element_buffer = get_element_buffer(buffer);
+    if (element_buffer != NULL && offset >= 0 && size >= 0 && offset + size <= element_buffer->size) {
+        memcpy(element_buffer->data + offset, data, size);
+        element_buffer->ranges_size = 0;
+        element_buffer->next_range = 0;
+    }
+    unlock_share_group();
+}
+void delete_element_buffer(const GLuint buffer) {
+    lock_share_group();
+    element_buffer_t *element_buffer = get_element_buffer(buffer);
+    if (element_buffer != NULL) {
+        free(element_buffer->data);
+        element_buffer->data = NULL;
+        element_buffer->size = 0;
+    }
+    unlock_share_group();
+}
+
+// Index Types
+GLsizei get_index_size(const GLenum type) {
+    switch (type) {
+        case GL_UNSIGNED_BYTE: {
+            return 1;
+        }
+        case GL_UNSIGNED_SHORT: {
+            return 2;
+        }
+        default: {
+            ERR("Unsupported Index Type: %i", type);
+        }
+    }
+}
+GLuint read_index(const GLenum type, const void *indices, const GLsizei i) {
+    if (type == GL_UNSIGNED_BYTE) {
+        return ((const GLubyte *) indices)[i];
+    } else {
+        return ((const GLushort *) indices)[i];
+    }
+}
+
+// Resolve Index Data
+static const void *get_buffer_index_data(const GLuint buffer, const GLenum type, const void *indices, const GLsizei count) {
+    const element_buffer_t *element_buffer = get_element_buffer(buffer);
+    const GLintptr offset = (GLintptr) indices;
+    if (element_buffer == NULL || offset < 0 || offset + ((GLsizeiptr) count * get_index_size(type)) > element_buffer->size) {
+        ERR("Element Array Buffer Data Is Unavailable");
+    }
+    return element_buffer->data + offset;
+}
+const void *get_index_data(const GLenum type, const void *indices, const GLsizei count) {
+    const GLuint buffer = get_element_array_buffer();
+    if (buffer == 0) {
+        return indices;
+    }
+    lock_share_group();
+    const void *data = get_buffer_index_data(buffer, type, indices, count);
+    unlock_share_group();
+    return data;
+}
+
+// Find Index Range
+#define scan_indices(index_type) \
+    { \
+        const index_type *data = indices; \
+        index_type low = data[0]; \
+        index_type high = data[0]; \
+        for (GLsizei i = 1; i < count; i++) { \
+            low = data[i] < low ? data[i] : low; \
+            high = data[i] > high ? data[i] : high; \
+        } \
+        *min = low; \
+        *max = high; \
+        break; \
+    }
+static void scan_index_range(const GLenum type, const void *indices, const GLsizei count, GLuint *min, GLuint *max) {
+    switch (type) {
+        case GL_UNSIGNED_BYTE: scan_indices(GLubyte);
+        case GL_UNSIGNED_SHORT: scan_indices(GLushort);
+        default: {
+            ERR("Unsupported Index Type: %i", type);
+        }
+    }
+}
+void get_index_range(const GLenum type, const void *indices, const GLsizei count, GLuint *min, GLuint *max) {
+    // Client-Side Data May Change At Any Time, So It Is Always Scanned
+    const GLuint buffer = get_element_array_buffer();
+    if (buffer == 0) {
+        scan_index_range(type, indices, count, min, max);
+        return;
+    }
+
+    // Check Cache
+    lock_share_group();
+    element_buffer_t *element_buffer = get_element_buffer(buffer);
+    const GLintptr offset = (GLintptr) indices;
+    if (element_buffer != NULL) {
+        for (int i = 0; i < element_buffer->ranges_size; i++) {
+            const index_range_t *range = &element_buffer->ranges[i];
+            if (range->offset == offset && range->count == count && range->type == type) {
+                *min = range->min;
+                *max = range->max;
+                unlock_share_group();
+                return;
+            }
+        }
+    }
+
+    // Scan And Store
+    scan_index_range(type, get_buffer_index_data(buffer, type, indices, count), count, min, max);
+    index_range_t *range = &element_buffer->ranges[element_buffer->next_range];
+    range->offset = offset;
+    range->count = count;
+    range->type = type;
+    range->min = *min;
+    range->max = *max;
+    element_buffer->next_range = (element_buffer->next_range + 1) % INDEX_RANGE_CACHE_SIZE;
+    if (element_buffer->ranges_size < INDEX_RANGE_CACHE_SIZE) {
+        element_buffer->ranges_size++;
+    }
+    unlock_share_group();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <GLES/gl.h>
+
+// Element Array Buffers
+// ES2 Cannot Read Buffers Back, So Index Data Is Kept On The CPU To Find The Vertices A Draw References
+#define INDEX_RANGE_CACHE_SIZE 4
+typedef struct {
+    GLintptr offset;
+    GLsizei count;
+    GLenum type;
+    GLuint min;
+    GLuint max;
+} index_range_t;
+typedef struct {
+    unsigned char *data;
+    GLsizeiptr size;
+    // Recently Used Ranges (Replaced Round-Robin)
+    index_range_t ranges[INDEX_RANGE_CACHE_SIZE];
+    int ranges_size;
+    int next_range;
+} element_buffer_t;
+// Shadowed Buffers (Indexed By Buffer Name, Part Of The Share Group)
+typedef struct {
+    element_buffer_t *buffers;
+    GLuint size;
+} element_buffers_t;
+void _free_gles_compatibility_layer_elements(element_buffers_t *elements);
+GLuint get_element_array_buffer();
+void element_buffer_data(GLuint buffer, GLsizeiptr size, const void *data);
+void element_buffer_sub_data(GLuint buffer, GLintptr offset, GLsizeiptr size, const void *data);
+void delete_element_buffer(GLuint buffer);
+
+// Indices
+GLsizei get_index_size(GLenum type);
+GLuint read_index(GLenum type, const void *indices, GLsizei i);
+// Returns The Index Data Of A Draw (Resolving Buffer Offsets Against The Bound Element Array Buffer)
+// Buffer Data Stays Valid Until The Buffer Is Respecified Or Deleted
+const void *get_index_data(GLenum type, const void *indices, GLsizei count);
+// Range Of Vertices Referenced By A Draw (Cached For Buffer Objects Until Their Data Changes)
+void get_index_range(GLenum type, const void *indices, GLsizei count, GLuint *min, GLuint *max);
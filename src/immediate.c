@@ -0,0 +1,136 @@
+#include <stddef.h>
+
+#include "context.h"
+#include "draw.h"
+#include "list.h"
+#include "primitives.h"
+#include "log.h"
+
+#include <GLES/gl.h>
+
+// Growable Vertex Arena
+static immediate_vertex_t *arena_add(arena_t *arena) {
+    if (arena->size >= arena->capacity) {
+        arena->capacity = arena->capacity > 0 ? arena->capacity * 2 : 1024;
+        arena->vertices = realloc(arena->vertices, arena->capacity * sizeof (immediate_vertex_t));
+        ALLOC_CHECK(arena->vertices);
+    }
+    return &arena->vertices[arena->size++];
+}
+
+// State
+#define immediate (current_context->immediate)
+void _free_gles_compatibility_layer_immediate() {
+    free(immediate.block.vertices);
+    free(immediate.batch.vertices);
+}
+
+// Draw The Batch
+void flush_immediate() {
+    const GLsizei size = immediate.batch.size;
+    immediate.batch.size = 0;
+    pending_immediate_size = 0;
+    if (size == 0) {
+        return;
+    }
+    // Streamed Like Any Other Client-Side Array
+    const unsigned char *base = (const unsigned char *) immediate.batch.vertices;
+    const array_pointer_t vertex = {
+        .enabled = 1,
+        .size = 3,
+        .type = GL_FLOAT,
+        .stride = sizeof (immediate_vertex_t),
+        .pointer = base + offsetof(immediate_vertex_t, position),
+        .buffer = 0
+    };
+    const array_pointer_t color = {
+        .enabled = 1,
+        .size = 4,
+        .type = GL_FLOAT,
+        .stride = sizeof (immediate_vertex_t),
+        .pointer = base + offsetof(immediate_vertex_t, color),
+        .buffer = 0
+    };
+    const array_pointer_t tex_coord = {
+        .enabled = 1,
+        .size = 2,
+        .type = GL_FLOAT,
+        .stride = sizeof (immediate_vertex_t),
+        .pointer = base + offsetof(immediate_vertex_t, tex_coord),
+        .buffer = 0
+    };
+    draw_buffer(immediate.batch_mode, &vertex, &color, &tex_coord, 0, size);
+}
+
+// Begin/End
+void glBegin(const GLenum mode) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glBegin, (mode));
+    if (immediate.active) {
+        ERR("glBegin Called Inside glBegin/glEnd");
+    }
+    if (COMPILING_LIST()) {
+        ERR("Immediate Mode Is Unsupported In Display Lists");
+    }
+    // Deferred Array Draws Come First
+    if (pending_draws_size > 0) {
+        flush_pending_draws();
+    }
+    // Only Blocks With The Same Primitive Type Are Merged
+    const GLenum batch_mode = get_list_primitive(mode);
+    if (pending_immediate_size > 0 && immediate.batch_mode != batch_mode) {
+        flush_immediate();
+    }
+    immediate.batch_mode = batch_mode;
+    immediate.mode = mode;
+    immediate.block.size = 0;
+    immediate.active = 1;
+}
+static void add_to_batch(__attribute__((unused)) void *data, const GLint index) {
+    *arena_add(&immediate.batch) = immediate.block.vertices[index];
+}
+void glEnd() {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glEnd, ());
+    if (!immediate.active) {
+        ERR("glEnd Called Outside glBegin/glEnd");
+    }
+    immediate.active = 0;
+    assemble_primitives(immediate.mode, 0, immediate.block.size, add_to_batch, NULL);
+    pending_immediate_size = immediate.batch.size;
+    // Blocks Are Only Merged When Deferred Draws Are Enabled
+    // The Layer Never Sees The Buffer Swap, So A Batch Still Pending Then Would Be Missing From The Frame
+    if (!are_draws_deferred()) {
+        flush_immediate();
+    }
+}
+
+// Vertex Data
+void glVertex3f(const GLfloat x, const GLfloat y, const GLfloat z) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glVertex3f, (x, y, z));
+    if (!immediate.active) {
+        ERR("glVertex Called Outside glBegin/glEnd");
+    }
+    immediate_vertex_t *vertex = arena_add(&immediate.block);
+    vertex->position[0] = x;
+    vertex->position[1] = y;
+    vertex->position[2] = z;
+    vertex->color[0] = gl_state.color.red;
+    vertex->color[1] = gl_state.color.green;
+    vertex->color[2] = gl_state.color.blue;
+    vertex->color[3] = gl_state.color.alpha;
+    vertex->tex_coord[0] = immediate.tex_coord[0];
+    vertex->tex_coord[1] = immediate.tex_coord[1];
+}
+void glVertex2f(const GLfloat x, const GLfloat y) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glVertex2f, (x, y));
+    glVertex3f(x, y, 0);
+}
+void glTexCoord2f(const GLfloat s, const GLfloat t) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glTexCoord2f, (s, t));
+    immediate.tex_coord[0] = s;
+    immediate.tex_coord[1] = t;
+}
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "instrumentation.h"
+#include "log.h"
+
+#ifdef GLES_COMPATIBILITY_LAYER_INSTRUMENTATION
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+// Sites
+#define MAX_SITES 512
+static instrumentation_site_t *sites[MAX_SITES];
+static _Atomic int sites_size = 0;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int get_site_id(instrumentation_site_t *site) {
+    int id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+    if (id < 0) {
+        pthread_mutex_lock(&lock);
+        id = site->id;
+        if (id < 0) {
+            id = atomic_load(&sites_size);
+            if (id >= MAX_SITES) {
+                ERR("Too Many Instrumented Functions");
+            }
+            sites[id] = site;
+            atomic_store(&sites_size, id + 1);
+            __atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&lock);
+    }
+    return id;
+}
+
+// Per-Thread Data
+// Only Written By Its Own Thread, Never Freed So Finished Threads Still Count
+typedef struct {
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t histogram[GLES_COMPATIBILITY_LAYER_HISTOGRAM_BUCKETS];
+} counter_t;
+typedef struct {
+    int site;
+    uint64_t start;
+    uint64_t duration;
+} trace_event_t;
+#define MAX_TRACE_EVENTS (256 * 1024)
+typedef struct thread_data {
+    struct thread_data *next;
+    int index;
+    counter_t counters[MAX_SITES];
+    // Trace (Events Past The Limit Are Dropped)
+    trace_event_t *events;
+    _Atomic int events_size;
+} thread_data_t;
+static thread_data_t *threads = NULL;
+static int threads_size = 0;
+static __thread thread_data_t *thread_data = NULL;
+static thread_data_t *get_thread_data() {
+    if (thread_data == NULL) {
+        thread_data = calloc(1, sizeof (thread_data_t));
+        ALLOC_CHECK(thread_data);
+        pthread_mutex_lock(&lock);
+        thread_data->index = threads_size++;
+        thread_data->next = threads;
+        threads = thread_data;
+        pthread_mutex_unlock(&lock);
+    }
+    return thread_data;
+}
+
+// Time
+static uint64_t get_time() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return ((uint64_t) time.tv_sec * 1000000000ull) + time.tv_nsec;
+}
+static int get_histogram_bucket(const uint64_t duration) {
+    const int bucket = duration > 1 ? 63 - __builtin_clzll(duration) : 0;
+    return bucket < GLES_COMPATIBILITY_LAYER_HISTOGRAM_BUCKETS ? bucket : GLES_COMPATIBILITY_LAYER_HISTOGRAM_BUCKETS - 1;
+}
+
+// Public Functions Called By Other Public Functions (Like glEnd Calling glDrawArrays) Are Part Of The Outer Call
+// Only The Outermost Entry Point On Each Thread Is Recorded, Nested Ones Have No Site
+static __thread int entry_point_depth = 0;
+
+// Record
+static _Atomic int tracing = 0;
+static uint64_t trace_start;
+instrumentation_scope_t begin_instrumented_scope(instrumentation_site_t *site) {
+    if (site->category == GLES_COMPATIBILITY_LAYER_ENTRY_POINT && entry_point_depth++ > 0) {
+        const instrumentation_scope_t nested = {
+            .site = NULL,
+            .start = 0
+        };
+        return nested;
+    }
+    const instrumentation_scope_t scope = {
+        .site = site,
+        .start = get_time()
+    };
+    return scope;
+}
+void end_instrumented_scope(const instrumentation_scope_t *scope) {
+    if (scope->site == NULL) {
+        entry_point_depth--;
+        return;
+    }
+    const uint64_t duration = get_time() - scope->start;
+    if (scope->site->category == GLES_COMPATIBILITY_LAYER_ENTRY_POINT) {
+        entry_point_depth--;
+    }
+    const int id = get_site_id(scope->site);
+    thread_data_t *data = get_thread_data();
+    counter_t *counter = &data->counters[id];
+    counter->calls++;
+    counter->total_ns += duration;
+    counter->histogram[get_histogram_bucket(duration)]++;
+    if (atomic_load_explicit(&tracing, memory_order_relaxed)) {
+        if (data->events == NULL) {
+            data->events = malloc(MAX_TRACE_EVENTS * sizeof (trace_event_t));
+            ALLOC_CHECK(data->events);
+        }
+        const int size = atomic_load_explicit(&data->events_size, memory_order_relaxed);
+        if (size < MAX_TRACE_EVENTS) {
+            trace_event_t *event = &data->events[size];
+            event->site = id;
+            event->start = scope->start;
+            event->duration = duration;
+            atomic_store_explicit(&data->events_size, size + 1, memory_order_release);
+        }
+    }
+}
+
+// Statistics
+int get_gles_compatibility_layer_call_stats(gles_compatibility_layer_call_stats_t *stats, const int max_stats) {
+    pthread_mutex_lock(&lock);
+    const int size = atomic_load(&sites_size);
+    for (int i = 0; i < size && i < max_stats; i++) {
+        gles_compatibility_layer_call_stats_t *out = &stats[i];
+        memset(out, 0, sizeof (gles_compatibility_layer_call_stats_t));
+        out->name = sites[i]->name;
+        out->category = sites[i]->category;
+        for (const thread_data_t *data = threads; data != NULL; data = data->next) {
+            const counter_t *counter = &data->counters[i];
+            out->calls += counter->calls;
+            out->total_ns += counter->total_ns;
+            for (int j = 0; j < GLES_COMPATIBILITY_LAYER_HISTOGRAM_BUCKETS; j++) {
+                out->histogram[j] += counter->histogram[j];
+            }
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return size;
+}
+void reset_gles_compatibility_layer_call_stats() {
+    pthread_mutex_lock(&lock);
+    for (thread_data_t *data = threads; data != NULL; data = data->next) {
+        memset(data->counters, 0, sizeof (data->counters));
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+// Trace
+void start_gles_compatibility_layer_trace() {
+    pthread_mutex_lock(&lock);
+    for (thread_data_t *data = threads; data != NULL; data = data->next) {
+        atomic_store(&data->events_size, 0);
+    }
+    trace_start = get_time();
+    pthread_mutex_unlock(&lock);
+    atomic_store(&tracing, 1);
+}
+static const char *get_category_name(const int category) {
+    switch (category) {
+        case GLES_COMPATIBILITY_LAYER_ENTRY_POINT: {
+            return "entry_point";
+        }
+        case GLES_COMPATIBILITY_LAYER_DRIVER_CALL: {
+            return "driver";
+        }
+        case GLES_COMPATIBILITY_LAYER_QUEUED_CALL: {
+            return "queued";
+        }
+        default: {
+            return "internal";
+        }
+    }
+}
+GLboolean stop_gles_compatibility_layer_trace(const char *path) {
+    atomic_store(&tracing, 0);
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return 0;
+    }
+    // Timestamps Are In Microseconds
+    pthread_mutex_lock(&lock);
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    int first = 1;
+    for (const thread_data_t *data = threads; data != NULL; data = data->next) {
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"Thread %i\"}}", first ? "" : ",", data->index, data->index);
+        first = 0;
+        const int size = atomic_load_explicit(&data->events_size, memory_order_acquire);
+        for (int i = 0; i < size; i++) {
+            const trace_event_t *event = &data->events[i];
+            const instrumentation_site_t *site = sites[event->site];
+            const double start = (double) (int64_t) (event->start - trace_start) / 1000.0;
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f}", site->name, get_category_name(site->category), data->index, start, (double) event->duration / 1000.0);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    pthread_mutex_unlock(&lock);
+    return fclose(file) == 0;
+}
+#else
+// Compiled Out
+int get_gles_compatibility_layer_call_stats(__attribute__((unused)) gles_compatibility_layer_call_stats_t *stats, __attribute__((unused)) const int max_stats) {
+    return 0;
+}
+void reset_gles_compatibility_layer_call_stats() {
+}
+void start_gles_compatibility_layer_trace() {
+}
+GLboolean stop_gles_compatibility_layer_trace(__attribute__((unused)) const char *path) {
+    return 0;
+}
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <GLES/gl.h>
+
+// Instrumentation
+// Calls Are Counted And Timed Per Thread, Everything Compiles To Nothing Unless GLES_COMPATIBILITY_LAYER_INSTRUMENTATION Is Defined
+#ifdef GLES_COMPATIBILITY_LAYER_INSTRUMENTATION
+typedef struct {
+    const char *name;
+    int category;
+    // Assigned On First Use
+    int id;
+} instrumentation_site_t;
+typedef struct {
+    instrumentation_site_t *site;
+    uint64_t start;
+} instrumentation_scope_t;
+instrumentation_scope_t begin_instrumented_scope(instrumentation_site_t *site);
+void end_instrumented_scope(const instrumentation_scope_t *scope);
+// Times The Rest Of The Enclosing Block
+#define INSTRUMENT_SCOPE(name, category) \
+    static instrumentation_site_t instrumentation_site = {name, category, -1}; \
+    __attribute__((cleanup(end_instrumented_scope))) const instrumentation_scope_t instrumentation_scope = begin_instrumented_scope(&instrumentation_site)
+#else
+#define INSTRUMENT_SCOPE(name, category)
+#endif
+
+// Public Functions (Only The Outermost Call On Each Thread Is Recorded)
+#define INSTRUMENT_ENTRY_POINT() INSTRUMENT_SCOPE(__func__, GLES_COMPATIBILITY_LAYER_ENTRY_POINT)
+// Internal Hot Paths
+#define INSTRUMENT_INTERNAL() INSTRUMENT_SCOPE(__func__, GLES_COMPATIBILITY_LAYER_INTERNAL)
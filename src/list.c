@@ -0,0 +1,501 @@
+#include <string.h>
+#include <stddef.h>
+
+#include "context.h"
+#include "draw.h"
+#include "list.h"
+#include "primitives.h"
+#include "elements.h"
+#include "log.h"
+
+#include <GLES/gl.h>
+
+// Lists (Name N Is Stored At Index N - 1)
+#define display_lists (current_context->share_group->lists.lists)
+#define display_lists_size (current_context->share_group->lists.size)
+static list_t *get_list(const GLuint name) {
+    if (name == 0 || name > display_lists_size || !display_lists[name - 1].exists) {
+        return NULL;
+    }
+    return &display_lists[name - 1];
+}
+static void reserve_lists(const GLuint size) {
+    if (size > display_lists_size) {
+        display_lists = realloc(display_lists, size * sizeof (list_t));
+        ALLOC_CHECK(display_lists);
+        for (GLuint i = display_lists_size; i < size; i++) {
+            display_lists[i].exists = 0;
+            display_lists[i].buffer = 0;
+            display_lists[i].ops = NULL;
+            display_lists[i].ops_size = 0;
+        }
+        display_lists_size = size;
+    }
+}
+static void free_list(list_t *list) {
+    if (list->buffer != 0) {
+        glDeleteBuffers(1, &list->buffer);
+        list->buffer = 0;
+    }
+    free(list->ops);
+    list->ops = NULL;
+    list->ops_size = 0;
+}
+
+// Compilation State
+#define compiling (current_context->list.compiling)
+static list_op_t *add_op(const int type) {
+    if (compiling.ops_size >= compiling.ops_capacity) {
+        compiling.ops_capacity = compiling.ops_capacity > 0 ? compiling.ops_capacity * 2 : 16;
+        compiling.ops = realloc(compiling.ops, compiling.ops_capacity * sizeof (list_op_t));
+        ALLOC_CHECK(compiling.ops);
+    }
+    list_op_t *op = &compiling.ops[compiling.ops_size++];
+    op->type = type;
+    return op;
+}
+
+// Free
+void _free_gles_compatibility_layer_lists(display_lists_t *lists) {
+    // Buffers Are Destroyed With The Real Context
+    for (GLuint i = 0; i < lists->size; i++) {
+        free(lists->lists[i].ops);
+    }
+    free(lists->lists);
+    lists->lists = NULL;
+    lists->size = 0;
+}
+void _free_gles_compatibility_layer_list_context() {
+    free(compiling.ops);
+    free(compiling.vertices);
+}
+
+// Create/Delete Lists
+GLuint glGenLists(const GLsizei range) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE_SCOPE();
+    if (range <= 0) {
+        return 0;
+    }
+    // Find Unused Range
+    lock_share_group();
+    GLuint first = 1;
+    for (GLuint name = 1; name <= display_lists_size && name - first < (GLuint) range; name++) {
+        if (display_lists[name - 1].exists) {
+            first = name + 1;
+        }
+    }
+    reserve_lists(first + range - 1);
+    for (GLsizei i = 0; i < range; i++) {
+        display_lists[first - 1 + i].exists = 1;
+    }
+    unlock_share_group();
+    CAPTURE_RESULT(glGenLists, (range, first));
+    return first;
+}
+void glDeleteLists(const GLuint list, const GLsizei range) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glDeleteLists, (list, range));
+    lock_share_group();
+    for (GLsizei i = 0; i < range; i++) {
+        list_t *obj = get_list(list + i);
+        if (obj != NULL) {
+            free_list(obj);
+            obj->exists = 0;
+        }
+    }
+    unlock_share_group();
+}
+
+// Compile
+void glNewList(const GLuint list, const GLenum mode) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glNewList, (list, mode));
+    if (COMPILING_LIST()) {
+        ERR("Display List Is Already Being Compiled");
+    }
+    if (mode != GL_COMPILE && mode != GL_COMPILE_AND_EXECUTE) {
+        ERR("Unsupported Display List Mode: %i", mode);
+    }
+    if (list == 0) {
+        ERR("Invalid Display List");
+    }
+    current_context->list.compiling_list = list;
+    compiling.mode = mode;
+    compiling.ops_size = 0;
+    compiling.vertices_size = 0;
+    compiling.matrices[0] = identity_matrix;
+    compiling.i = 0;
+    compiling.has_color = 0;
+}
+void glEndList() {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glEndList, ());
+    if (!COMPILING_LIST()) {
+        ERR("No Display List Is Being Compiled");
+    }
+    if (compiling.i != 0) {
+        ERR("Unbalanced Matrix Stack In Display List");
+    }
+
+    // Lasting Effects On The Caller's State
+    if (memcmp(&compiling.matrices[0], &identity_matrix, sizeof (matrix_t)) != 0) {
+        add_op(LIST_OP_MULT_MATRIX)->matrix = compiling.matrices[0];
+    }
+    if (compiling.has_color) {
+        add_op(LIST_OP_COLOR)->color = compiling.color;
+    }
+
+    // Replace Old Contents
+    const GLuint name = current_context->list.compiling_list;
+    current_context->list.compiling_list = 0;
+    lock_share_group();
+    reserve_lists(name);
+    list_t *list = &display_lists[name - 1];
+    free_list(list);
+    list->exists = 1;
+
+    // Upload Vertices
+    if (compiling.vertices_size > 0) {
+        GLint current_buffer;
+        glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &current_buffer);
+        glGenBuffers(1, &list->buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, list->buffer);
+        glBufferData(GL_ARRAY_BUFFER, compiling.vertices_size * sizeof (list_vertex_t), compiling.vertices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, current_buffer);
+    }
+
+    // Store Operations
+    if (compiling.ops_size > 0) {
+        list->ops = malloc(compiling.ops_size * sizeof (list_op_t));
+        ALLOC_CHECK(list->ops);
+        memcpy(list->ops, compiling.ops, compiling.ops_size * sizeof (list_op_t));
+        list->ops_size = compiling.ops_size;
+    }
+    unlock_share_group();
+
+    // Execute
+    if (compiling.mode == GL_COMPILE_AND_EXECUTE) {
+        glCallList(name);
+    }
+}
+
+// Record Colors
+void list_color(const GLfloat red, const GLfloat green, const GLfloat blue, const GLfloat alpha) {
+    compiling.has_color = 1;
+    compiling.color.red = red;
+    compiling.color.green = green;
+    compiling.color.blue = blue;
+    compiling.color.alpha = alpha;
+}
+static unsigned char color_to_byte(const GLfloat value) {
+    if (value <= 0) {
+        return 0;
+    } else if (value >= 1) {
+        return 255;
+    } else {
+        return (unsigned char) ((value * 255.f) + 0.5f);
+    }
+}
+
+// Record Matrix Operations
+static matrix_t *get_compiling_matrix() {
+    if (gl_state.matrix_stacks.mode != GL_MODELVIEW) {
+        ERR("Display Lists Only Support Model View Matrix Operations");
+    }
+    return &compiling.matrices[compiling.i];
+}
+void list_push_matrix() {
+    matrix_t *matrix = get_compiling_matrix();
+    if (compiling.i + 1 >= MATRIX_STACK_DEPTH) {
+        ERR("Display List Matrix Stack Overflow");
+    }
+    compiling.matrices[++compiling.i] = *matrix;
+}
+void list_pop_matrix() {
+    get_compiling_matrix();
+    if (compiling.i == 0) {
+        ERR("Display List Pops A Matrix It Did Not Push");
+    }
+    compiling.i--;
+}
+void list_load_identity() {
+    matrix_t *matrix = get_compiling_matrix();
+    if (compiling.i != 0) {
+        ERR("Unsupported glLoadIdentity Inside A Pushed Matrix In Display List");
+    }
+    // Later Draws Are Relative To The Identity Matrix Instead Of The Caller's Matrix
+    add_op(LIST_OP_LOAD_IDENTITY);
+    *matrix = identity_matrix;
+}
+void list_mult_matrix(const matrix_t *m) {
+    matrix_t *matrix = get_compiling_matrix();
+    multiply_matrices(matrix, matrix, m);
+    // Baked Positions Have No W Component
+    if (matrix->data[0][3] != 0 || matrix->data[1][3] != 0 || matrix->data[2][3] != 0 || matrix->data[3][3] != 1) {
+        ERR("Unsupported Projective Transform In Display List");
+    }
+}
+
+// Record Draws
+static void read_attribute(const array_pointer_t *array, const GLint index, GLfloat *out) {
+    // Missing Components Default To (0, 0, 0, 1)
+    out[0] = 0;
+    out[1] = 0;
+    out[2] = 0;
+    out[3] = 1;
+    const GLsizei element_size = array->size * get_type_size(array->type);
+    const GLsizei stride = array->stride != 0 ? array->stride : element_size;
+    const void *element = ((const unsigned char *) array->pointer) + (index * stride);
+    for (int i = 0; i < array->size; i++) {
+        switch (array->type) {
+            case GL_BYTE: {
+                out[i] = ((const signed char *) element)[i];
+                break;
+            }
+            case GL_UNSIGNED_BYTE: {
+                // Only Used For Normalized Colors
+                out[i] = ((const unsigned char *) element)[i] / 255.f;
+                break;
+            }
+            case GL_SHORT: {
+                out[i] = ((const short *) element)[i];
+                break;
+            }
+            case GL_FIXED: {
+                out[i] = ((const GLfixed *) element)[i] / 65536.f;
+                break;
+            }
+            case GL_FLOAT: {
+                out[i] = ((const GLfloat *) element)[i];
+                break;
+            }
+        }
+    }
+}
+static void add_vertex(void *data, const GLint index) {
+    const array_pointer_t *const *arrays = data;
+    const array_pointer_t *color = arrays[0];
+    const array_pointer_t *tex_coord = arrays[1];
+    if (compiling.vertices_size >= compiling.vertices_capacity) {
+        compiling.vertices_capacity = compiling.vertices_capacity > 0 ? compiling.vertices_capacity * 2 : 1024;
+        compiling.vertices = realloc(compiling.vertices, compiling.vertices_capacity * sizeof (list_vertex_t));
+        ALLOC_CHECK(compiling.vertices);
+    }
+    list_vertex_t *out = &compiling.vertices[compiling.vertices_size++];
+
+    // Position
+    GLfloat position[4];
+    read_attribute(&gl_state.array_pointers.vertex, index, position);
+    if (position[3] != 1) {
+        ERR("Unsupported Homogeneous Position In Display List");
+    }
+    const matrix_t *matrix = &compiling.matrices[compiling.i];
+    for (int i = 0; i < 3; i++) {
+        out->position[i] = (matrix->data[0][i] * position[0]) + (matrix->data[1][i] * position[1]) + (matrix->data[2][i] * position[2]) + matrix->data[3][i];
+    }
+
+    // Color
+    if (color != NULL) {
+        GLfloat value[4];
+        read_attribute(color, index, value);
+        for (int i = 0; i < 4; i++) {
+            out->color[i] = color_to_byte(value[i]);
+        }
+    } else if (compiling.has_color) {
+        out->color[0] = color_to_byte(compiling.color.red);
+        out->color[1] = color_to_byte(compiling.color.green);
+        out->color[2] = color_to_byte(compiling.color.blue);
+        out->color[3] = color_to_byte(compiling.color.alpha);
+    } else {
+        memset(out->color, 0, 4);
+    }
+
+    // Texture Coordinates
+    if (tex_coord != NULL) {
+        GLfloat value[4];
+        read_attribute(tex_coord, index, value);
+        out->tex_coord[0] = value[0];
+        out->tex_coord[1] = value[1];
+    } else {
+        out->tex_coord[0] = 0;
+        out->tex_coord[1] = 0;
+    }
+}
+// Indexed Draws Read Vertices Through The Index Array
+typedef struct {
+    const array_pointer_t *const *arrays;
+    GLenum type;
+    const void *indices;
+} list_elements_t;
+static void add_indexed_vertex(void *data, const GLint i) {
+    const list_elements_t *elements = data;
+    add_vertex((void *) elements->arrays, read_index(elements->type, elements->indices, i));
+}
+// Indices Are NULL For Array Draws
+static void record_draw(const GLenum mode, const GLint first, const GLsizei count, const GLenum type, const void *indices) {
+    // Verify
+    if (!gl_state.array_pointers.vertex.enabled || !is_supported_vertex_array(&gl_state.array_pointers.vertex)) {
+        ERR("Unsupported Vertex Configuration");
+    }
+    const array_pointer_t *color = gl_state.array_pointers.color.enabled ? &gl_state.array_pointers.color : NULL;
+    if (color != NULL && !is_supported_color_array(color)) {
+        ERR("Unsupported Color Configuration");
+    }
+    const array_pointer_t *tex_coord = gl_state.array_pointers.tex_coord.enabled ? &gl_state.array_pointers.tex_coord : NULL;
+    if (tex_coord != NULL && !is_supported_tex_coord_array(tex_coord)) {
+        if (gl_state.texture_2d) {
+            ERR("Unsupported Texture Configuration");
+        }
+        tex_coord = NULL;
+    }
+    // Vertex Data Is Read Back On The CPU
+    if (gl_state.array_pointers.vertex.buffer != 0 || (color != NULL && color->buffer != 0) || (tex_coord != NULL && tex_coord->buffer != 0)) {
+        ERR("Display Lists Only Support Client-Side Arrays");
+    }
+
+    // Check
+    if (count <= 0) {
+        return;
+    }
+
+    // Extend The Previous Draw When Possible
+    const GLenum primitive = get_list_primitive(mode);
+    const GLboolean has_color = color != NULL || compiling.has_color;
+    const GLboolean has_tex_coord = tex_coord != NULL;
+    list_op_t *op = compiling.ops_size > 0 ? &compiling.ops[compiling.ops_size - 1] : NULL;
+    if (op == NULL || op->type != LIST_OP_DRAW || op->draw.mode != primitive || op->draw.has_color != has_color || op->draw.has_tex_coord != has_tex_coord) {
+        op = add_op(LIST_OP_DRAW);
+        op->draw.mode = primitive;
+        op->draw.first = compiling.vertices_size;
+        op->draw.count = 0;
+        op->draw.has_color = has_color;
+        op->draw.has_tex_coord = has_tex_coord;
+    }
+
+    // Assemble Primitives
+    const GLsizei start = compiling.vertices_size;
+    const array_pointer_t *arrays[] = {color, tex_coord};
+    if (indices != NULL) {
+        list_elements_t elements = {arrays, type, indices};
+        assemble_primitives(mode, first, count, add_indexed_vertex, &elements);
+    } else {
+        assemble_primitives(mode, first, count, add_vertex, arrays);
+    }
+    op->draw.count += compiling.vertices_size - start;
+}
+void list_draw_arrays(const GLenum mode, const GLint first, const GLsizei count) {
+    record_draw(mode, first, count, 0, NULL);
+}
+void list_draw_elements(const GLenum mode, const GLsizei count, const GLenum type, const void *indices) {
+    // Verify Index Type
+    get_index_size(type);
+    if (count <= 0) {
+        return;
+    }
+    record_draw(mode, 0, count, type, get_index_data(type, indices, count));
+}
+
+// Replay
+static void model_view_op(void (*func)(const GLfloat *), const GLfloat *data) {
+    // List Matrix Operations Always Target The Model View Matrix
+    const GLenum mode = gl_state.matrix_stacks.mode;
+    glMatrixMode(GL_MODELVIEW);
+    func(data);
+    glMatrixMode(mode);
+}
+static void load_identity(__attribute__((unused)) const GLfloat *data) {
+    glLoadIdentity();
+}
+void glCallList(const GLuint name) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glCallList, (name));
+    if (COMPILING_LIST()) {
+        ERR("Nested Display Lists Are Unsupported");
+    }
+    // Locked So Other Contexts Cannot Replace The List While It Runs
+    lock_share_group();
+    const list_t *list = get_list(name);
+    if (list == NULL) {
+        unlock_share_group();
+        return;
+    }
+
+    // Baked Vertex Layout
+    const array_pointer_t vertex = {
+        .enabled = 1,
+        .size = 3,
+        .type = GL_FLOAT,
+        .stride = sizeof (list_vertex_t),
+        .pointer = (const void *) offsetof(list_vertex_t, position),
+        .buffer = list->buffer
+    };
+    const array_pointer_t color = {
+        .enabled = 1,
+        .size = 4,
+        .type = GL_UNSIGNED_BYTE,
+        .stride = sizeof (list_vertex_t),
+        .pointer = (const void *) offsetof(list_vertex_t, color),
+        .buffer = list->buffer
+    };
+    const array_pointer_t tex_coord = {
+        .enabled = 1,
+        .size = 2,
+        .type = GL_FLOAT,
+        .stride = sizeof (list_vertex_t),
+        .pointer = (const void *) offsetof(list_vertex_t, tex_coord),
+        .buffer = list->buffer
+    };
+
+    // Run
+    FLUSH_DRAWS();
+    for (int i = 0; i < list->ops_size; i++) {
+        const list_op_t *op = &list->ops[i];
+        switch (op->type) {
+            case LIST_OP_DRAW: {
+                if (op->draw.count > 0) {
+                    draw_buffer(op->draw.mode, &vertex, op->draw.has_color ? &color : NULL, op->draw.has_tex_coord ? &tex_coord : NULL, op->draw.first, op->draw.count);
+                }
+                break;
+            }
+            case LIST_OP_LOAD_IDENTITY: {
+                model_view_op(load_identity, NULL);
+                break;
+            }
+            case LIST_OP_MULT_MATRIX: {
+                model_view_op(glMultMatrixf, &op->matrix.data[0][0]);
+                break;
+            }
+            case LIST_OP_COLOR: {
+                glColor4f(op->color.red, op->color.green, op->color.blue, op->color.alpha);
+                break;
+            }
+        }
+    }
+    unlock_share_group();
+}
+void glCallLists(const GLsizei n, const GLenum type, const GLvoid *lists) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glCallLists, (n, type, lists));
+    for (GLsizei i = 0; i < n; i++) {
+        GLuint name;
+        switch (type) {
+            case GL_UNSIGNED_BYTE: {
+                name = ((const unsigned char *) lists)[i];
+                break;
+            }
+            case GL_UNSIGNED_SHORT: {
+                name = ((const unsigned short *) lists)[i];
+                break;
+            }
+            case GL_UNSIGNED_INT: {
+                name = ((const GLuint *) lists)[i];
+                break;
+            }
+            default: {
+                ERR("Unsupported Display List Name Type: %i", type);
+            }
+        }
+        glCallList(name);
+    }
+}
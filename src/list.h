@@ -0,0 +1,81 @@
+#pragma once
+
+#include <GLES/gl.h>
+
+#include "matrix.h"
+#include "state.h"
+
+// Display Lists
+// While A List Is Being Compiled, Model View Matrix Operations, Colors And Draws Are Recorded Instead Of Executed
+#define COMPILING_LIST() (current_context->list.compiling_list != 0)
+
+// Baked Vertex Format
+// Positions Are Pre-Transformed By The Matrix Operations Recorded Before Each Draw
+typedef struct {
+    GLfloat position[3];
+    unsigned char color[4];
+    GLfloat tex_coord[2];
+} list_vertex_t;
+
+// Operations
+#define LIST_OP_DRAW 0
+#define LIST_OP_LOAD_IDENTITY 1
+#define LIST_OP_MULT_MATRIX 2
+#define LIST_OP_COLOR 3
+typedef struct {
+    int type;
+    union {
+        struct {
+            GLenum mode;
+            GLint first;
+            GLsizei count;
+            GLboolean has_color;
+            GLboolean has_tex_coord;
+        } draw;
+        matrix_t matrix;
+        color_t color;
+    };
+} list_op_t;
+
+// Lists (Name N Is Stored At Index N - 1, Part Of The Share Group)
+typedef struct {
+    GLboolean exists;
+    GLuint buffer;
+    list_op_t *ops;
+    int ops_size;
+} list_t;
+typedef struct {
+    list_t *lists;
+    GLuint size;
+} display_lists_t;
+void _free_gles_compatibility_layer_lists(display_lists_t *lists);
+
+// Compilation State (Per Context)
+typedef struct {
+    GLuint compiling_list;
+    struct {
+        GLenum mode;
+        list_op_t *ops;
+        int ops_size;
+        int ops_capacity;
+        list_vertex_t *vertices;
+        GLsizei vertices_size;
+        GLsizei vertices_capacity;
+        // Model View Matrix Relative To The One Active When The List Is Called
+        matrix_t matrices[MATRIX_STACK_DEPTH];
+        unsigned int i;
+        // Color Set Inside The List
+        GLboolean has_color;
+        color_t color;
+    } compiling;
+} list_context_t;
+void _free_gles_compatibility_layer_list_context();
+
+// Recording
+void list_draw_arrays(GLenum mode, GLint first, GLsizei count);
+void list_draw_elements(GLenum mode, GLsizei count, GLenum type, const void *indices);
+void list_color(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void list_push_matrix();
+void list_pop_matrix();
+void list_load_identity();
+void list_mult_matrix(const matrix_t *m);
@@ -1,17 +1,199 @@
 #include <math.h>
 #include <string.h>
 
+// SIMD Implementation (Selected At Build Time)
+#ifndef GLES_COMPATIBILITY_LAYER_NO_SIMD
+#if defined(__AVX__)
+#define MATRIX_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define MATRIX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define MATRIX_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 #include "log.h"
 
-#include "state.h"
+#include "context.h"
+#include "draw.h"
+#include "list.h"
 
 // Matrix Common
-static void matrix_copy(matrix_t *src, matrix_t *dst) {
-    memcpy((void *) dst->data, (void *) src->data, MATRIX_DATA_SIZE);
+static void matrix_copy(const matrix_t *src, matrix_t *dst) {
+    memcpy((void *) dst->data, (const void *) src->data, MATRIX_DATA_SIZE);
+}
+
+// Multiply Matrices
+void multiply_matrices_scalar(matrix_t *out, const matrix_t *a, const matrix_t *b) {
+    matrix_t new_matrix;
+    for (int x = 0; x < MATRIX_SIZE; x++) {
+        for (int y = 0; y < MATRIX_SIZE; y++) {
+            GLfloat result = 0;
+            for (int i = 0; i < MATRIX_SIZE; i++) {
+                result += (a->data[i][y] * b->data[x][i]);
+            }
+            new_matrix.data[x][y] = result;
+        }
+    }
+    matrix_copy(&new_matrix, out);
+}
+// Each Output Column Is A Linear Combination Of The Columns Of a
+// All Inputs Are Loaded Before Anything Is Stored, So out May Alias Either Input
+#if defined(MATRIX_AVX)
+// Two Output Columns Per Instruction
+void multiply_matrices(matrix_t *out, const matrix_t *a, const matrix_t *b) {
+    const __m256 a0 = _mm256_broadcast_ps((const __m128 *) a->data[0]);
+    const __m256 a1 = _mm256_broadcast_ps((const __m128 *) a->data[1]);
+    const __m256 a2 = _mm256_broadcast_ps((const __m128 *) a->data[2]);
+    const __m256 a3 = _mm256_broadcast_ps((const __m128 *) a->data[3]);
+    const __m256 b01 = _mm256_loadu_ps(b->data[0]);
+    const __m256 b23 = _mm256_loadu_ps(b->data[2]);
+#define column_pair(columns) \
+    _mm256_add_ps(_mm256_add_ps(_mm256_add_ps( \
+        _mm256_mul_ps(a0, _mm256_shuffle_ps(columns, columns, 0x00)), \
+        _mm256_mul_ps(a1, _mm256_shuffle_ps(columns, columns, 0x55))), \
+        _mm256_mul_ps(a2, _mm256_shuffle_ps(columns, columns, 0xaa))), \
+        _mm256_mul_ps(a3, _mm256_shuffle_ps(columns, columns, 0xff)))
+    const __m256 out01 = column_pair(b01);
+    const __m256 out23 = column_pair(b23);
+#undef column_pair
+    _mm256_storeu_ps(out->data[0], out01);
+    _mm256_storeu_ps(out->data[2], out23);
+}
+#elif defined(MATRIX_SSE2)
+void multiply_matrices(matrix_t *out, const matrix_t *a, const matrix_t *b) {
+    const __m128 a0 = _mm_load_ps(a->data[0]);
+    const __m128 a1 = _mm_load_ps(a->data[1]);
+    const __m128 a2 = _mm_load_ps(a->data[2]);
+    const __m128 a3 = _mm_load_ps(a->data[3]);
+    __m128 columns[MATRIX_SIZE];
+    for (int x = 0; x < MATRIX_SIZE; x++) {
+        columns[x] = _mm_loadu_ps(b->data[x]);
+    }
+    for (int x = 0; x < MATRIX_SIZE; x++) {
+        const __m128 column = columns[x];
+        __m128 result = _mm_mul_ps(a0, _mm_shuffle_ps(column, column, 0x00));
+        result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_shuffle_ps(column, column, 0x55)));
+        result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_shuffle_ps(column, column, 0xaa)));
+        result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_shuffle_ps(column, column, 0xff)));
+        _mm_store_ps(out->data[x], result);
+    }
+}
+#elif defined(MATRIX_NEON)
+void multiply_matrices(matrix_t *out, const matrix_t *a, const matrix_t *b) {
+    const float32x4_t a0 = vld1q_f32(a->data[0]);
+    const float32x4_t a1 = vld1q_f32(a->data[1]);
+    const float32x4_t a2 = vld1q_f32(a->data[2]);
+    const float32x4_t a3 = vld1q_f32(a->data[3]);
+    float32x4_t columns[MATRIX_SIZE];
+    for (int x = 0; x < MATRIX_SIZE; x++) {
+        columns[x] = vld1q_f32(b->data[x]);
+    }
+    for (int x = 0; x < MATRIX_SIZE; x++) {
+        const float32x2_t low = vget_low_f32(columns[x]);
+        const float32x2_t high = vget_high_f32(columns[x]);
+        float32x4_t result = vmulq_lane_f32(a0, low, 0);
+        result = vmlaq_lane_f32(result, a1, low, 1);
+        result = vmlaq_lane_f32(result, a2, high, 0);
+        result = vmlaq_lane_f32(result, a3, high, 1);
+        vst1q_f32(out->data[x], result);
+    }
+}
+#else
+void multiply_matrices(matrix_t *out, const matrix_t *a, const matrix_t *b) {
+    multiply_matrices_scalar(out, a, b);
+}
+#endif
+
+// Matrix Types
+int get_matrix_type(const matrix_t *m) {
+    const GLfloat (*data)[MATRIX_SIZE] = m->data;
+    if (data[0][3] != 0 || data[1][3] != 0 || data[2][3] != 0 || data[3][3] != 1) {
+        return MATRIX_TYPE_GENERAL;
+    }
+    int type = MATRIX_TYPE_IDENTITY;
+    if (data[0][1] != 0 || data[0][2] != 0 || data[1][0] != 0 || data[1][2] != 0 || data[2][0] != 0 || data[2][1] != 0) {
+        type |= MATRIX_TYPE_AFFINE;
+    } else if (data[0][0] != 1 || data[1][1] != 1 || data[2][2] != 1) {
+        type |= MATRIX_TYPE_SCALE;
+    }
+    if (data[3][0] != 0 || data[3][1] != 0 || data[3][2] != 0) {
+        type |= MATRIX_TYPE_TRANSLATE;
+    }
+    return type;
+}
+int multiply_typed_matrices(matrix_t *out, const matrix_t *a, const int a_type, const matrix_t *b, const int b_type) {
+    if (b_type == MATRIX_TYPE_IDENTITY) {
+        if (out != a) {
+            matrix_copy(a, out);
+        }
+    } else if (a_type == MATRIX_TYPE_IDENTITY) {
+        matrix_copy(b, out);
+    } else if ((b_type & ~(MATRIX_TYPE_SCALE | MATRIX_TYPE_TRANSLATE)) == 0) {
+        // Only The Diagonal And The Last Column Of b Are Set
+        if (out != a) {
+            matrix_copy(a, out);
+        }
+        if (b_type & MATRIX_TYPE_TRANSLATE) {
+            // The Last Column Is Updated Before The Others Are Scaled
+            for (int y = 0; y < MATRIX_SIZE; y++) {
+                out->data[3][y] = (out->data[0][y] * b->data[3][0]) + (out->data[1][y] * b->data[3][1]) + (out->data[2][y] * b->data[3][2]) + out->data[3][y];
+            }
+        }
+        if (b_type & MATRIX_TYPE_SCALE) {
+            for (int x = 0; x < 3; x++) {
+                for (int y = 0; y < MATRIX_SIZE; y++) {
+                    out->data[x][y] *= b->data[x][x];
+                }
+            }
+        }
+    } else {
+        multiply_matrices(out, a, b);
+    }
+    return a_type | b_type;
+}
+
+// Matrix Stack Storage
+// Allocated Manually Because realloc() Does Not Preserve Alignment
+static void grow_matrix_stack(matrix_stack_t *stack) {
+    const unsigned int capacity = stack->capacity > 0 ? stack->capacity * 2 : 4;
+    matrix_slot_t *slots = NULL;
+    if (posix_memalign((void **) &slots, MATRIX_ALIGNMENT, capacity * sizeof (matrix_slot_t)) != 0) {
+        slots = NULL;
+    }
+    ALLOC_CHECK(slots);
+    if (stack->slots != NULL) {
+        memcpy((void *) slots, (const void *) stack->slots, stack->size * sizeof (matrix_slot_t));
+        free(stack->slots);
+    }
+    stack->slots = slots;
+    stack->capacity = capacity;
+}
+// Get The Top Of The Stack For Modification, Materializing A Pending Push
+static matrix_slot_t *get_writable_top(matrix_stack_t *stack, const int copy) {
+    matrix_slot_t *top = MATRIX_STACK_TOP(stack);
+    if (top->pending_pushes > 0) {
+        top->pending_pushes--;
+        if (stack->size >= stack->capacity) {
+            grow_matrix_stack(stack);
+            top = MATRIX_STACK_TOP(stack);
+        }
+        matrix_slot_t *new_top = &stack->slots[stack->size++];
+        if (copy) {
+            matrix_copy(&top->matrix, &new_top->matrix);
+            new_top->type = top->type;
+        }
+        new_top->pending_pushes = 0;
+        top = new_top;
+    }
+    return top;
 }
 
 // Identity Matrix
-static matrix_t identity_matrix = {
+matrix_t identity_matrix = {
     .data = {
         {1, 0, 0, 0},
         {0, 1, 0, 0},
@@ -20,7 +202,16 @@ static matrix_t identity_matrix = {
     }
 };
 static void init_matrix_stack(matrix_stack_t *stack) {
-    matrix_copy(&identity_matrix, &stack->stack[0]);
+    if (stack->capacity == 0) {
+        grow_matrix_stack(stack);
+    }
+    stack->size = 1;
+    stack->depth = 1;
+    matrix_slot_t *top = MATRIX_STACK_TOP(stack);
+    matrix_copy(&identity_matrix, &top->matrix);
+    top->type = MATRIX_TYPE_IDENTITY;
+    top->pending_pushes = 0;
+    stack->generation = 1;
 }
 void _init_gles_compatibility_matrix_stacks() {
     init_matrix_stack(&gl_state.matrix_stacks.model_view);
@@ -48,64 +239,126 @@ static matrix_stack_t *get_matrix_stack() {
 
 // Matrix Functions
 void glMatrixMode(GLenum mode) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glMatrixMode, (mode));
     gl_state.matrix_stacks.mode = mode;
 }
 void glPopMatrix() {
-    get_matrix_stack()->i--;
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glPopMatrix, ());
+    if (COMPILING_LIST()) {
+        list_pop_matrix();
+        return;
+    }
+    matrix_stack_t *stack = get_matrix_stack();
+    if (stack->depth <= 1) {
+        ERR("Matrix Stack Underflow");
+    }
+    stack->depth--;
+    matrix_slot_t *top = MATRIX_STACK_TOP(stack);
+    if (top->pending_pushes > 0) {
+        // The Matrix Was Never Modified
+        top->pending_pushes--;
+    } else {
+        FLUSH_DRAWS();
+        stack->size--;
+        stack->generation++;
+    }
 }
 void glLoadIdentity() {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glLoadIdentity, ());
+    if (COMPILING_LIST()) {
+        list_load_identity();
+        return;
+    }
+    FLUSH_DRAWS();
     matrix_stack_t *stack = get_matrix_stack();
-    matrix_copy(&identity_matrix, &stack->stack[stack->i]);
+    matrix_slot_t *top = get_writable_top(stack, 0);
+    matrix_copy(&identity_matrix, &top->matrix);
+    top->type = MATRIX_TYPE_IDENTITY;
+    stack->generation++;
 }
 void glPushMatrix() {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glPushMatrix, ());
+    if (COMPILING_LIST()) {
+        list_push_matrix();
+        return;
+    }
+    // Copied On The First Modification
     matrix_stack_t *stack = get_matrix_stack();
-    matrix_copy(&stack->stack[stack->i], &stack->stack[stack->i + 1]);
-    stack->i++;
+    if (stack->depth >= MATRIX_STACK_DEPTH) {
+        ERR("Matrix Stack Overflow");
+    }
+    stack->depth++;
+    MATRIX_STACK_TOP(stack)->pending_pushes++;
 }
-void glMultMatrixf(const GLfloat *m) {
-    matrix_t new_matrix;
-    matrix_stack_t *stack = get_matrix_stack();
-    matrix_t *current_matrix = &stack->stack[stack->i];
-    for (int x = 0; x < MATRIX_SIZE; x++) {
-        for (int y = 0; y < MATRIX_SIZE; y++) {
-            GLfloat result = 0;
-            for (int i = 0; i < MATRIX_SIZE; i++) {
-                result += (current_matrix->data[i][y] * m[(x * MATRIX_SIZE) + i]);
-            }
-            new_matrix.data[x][y] = result;
-        }
+static void mult_matrix(const matrix_t *m, const int type) {
+    if (COMPILING_LIST()) {
+        list_mult_matrix(m);
+        return;
     }
-    matrix_copy(&new_matrix, current_matrix);
+    if (type == MATRIX_TYPE_IDENTITY) {
+        return;
+    }
+    FLUSH_DRAWS();
+    matrix_stack_t *stack = get_matrix_stack();
+    matrix_slot_t *top = get_writable_top(stack, 1);
+    top->type = multiply_typed_matrices(&top->matrix, &top->matrix, top->type, m, type);
+    stack->generation++;
+}
+void glMultMatrixf(const GLfloat *m) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glMultMatrixf, (m));
+    // The Application's Matrix May Not Be Aligned
+    matrix_t matrix;
+    memcpy((void *) matrix.data, (const void *) m, MATRIX_DATA_SIZE);
+    mult_matrix(&matrix, get_matrix_type(&matrix));
 }
 void glScalef(GLfloat x, GLfloat y, GLfloat z) {
-    GLfloat m[] = {
-        x, 0, 0, 0,
-        0, y, 0, 0,
-        0, 0, z, 0,
-        0, 0, 0, 1
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glScalef, (x, y, z));
+    matrix_t m = {
+        .data = {
+            {x, 0, 0, 0},
+            {0, y, 0, 0},
+            {0, 0, z, 0},
+            {0, 0, 0, 1}
+        }
     };
-    glMultMatrixf(m);
+    mult_matrix(&m, MATRIX_TYPE_SCALE);
 }
 void glTranslatef(GLfloat x, GLfloat y, GLfloat z) {
-    GLfloat m[] = {
-        1, 0, 0, 0,
-        0, 1, 0, 0,
-        0, 0, 1, 0,
-        x, y, z, 1
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glTranslatef, (x, y, z));
+    matrix_t m = {
+        .data = {
+            {1, 0, 0, 0},
+            {0, 1, 0, 0},
+            {0, 0, 1, 0},
+            {x, y, z, 1}
+        }
     };
-    glMultMatrixf(m);
+    mult_matrix(&m, MATRIX_TYPE_TRANSLATE);
 }
 void glOrthof(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat near, GLfloat far) {
-    GLfloat m[] = {
-        (2.f / (right - left)), 0, 0, 0,
-        0, (2.f / (top - bottom)), 0, 0,
-        0, 0, (-2.f / (far - near)), 0,
-        -((right + left) / (right - left)), -((top + bottom) / (top - bottom)), -((far + near) / (far - near)), 1
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glOrthof, (left, right, bottom, top, near, far));
+    matrix_t m = {
+        .data = {
+            {(2.f / (right - left)), 0, 0, 0},
+            {0, (2.f / (top - bottom)), 0, 0},
+            {0, 0, (-2.f / (far - near)), 0},
+            {-((right + left) / (right - left)), -((top + bottom) / (top - bottom)), -((far + near) / (far - near)), 1}
+        }
     };
-    glMultMatrixf(m);
+    mult_matrix(&m, MATRIX_TYPE_SCALE | MATRIX_TYPE_TRANSLATE);
 }
 #define DEG2RAD (M_PI / 180.f)
 void glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glRotatef, (angle, x, y, z));
     // Normalize
     GLfloat length = sqrtf((x * x) + (y * y) + (z * z));
     x /= length;
@@ -121,11 +374,13 @@ void glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z) {
     GLfloat z2 = z * z;
 
     // Multiply
-    GLfloat m[] = {
-        x2 * (1.f - c) + c, (x * y) * (1.f - c) + (z * s), (x * z) * (1.f - c) - (y * s), 0,
-        (x * y) * (1.f - c) - (z * s), y2 * (1.f - c) + c, (y * z) * (1.f - c) + (x * s), 0,
-        (x * z) * (1.f - c) + (y * s), (y * z) * (1.f - c) - (x * s), z2 * (1.f - c) + c, 0,
-        0, 0, 0, 1.f
+    matrix_t m = {
+        .data = {
+            {x2 * (1.f - c) + c, (x * y) * (1.f - c) + (z * s), (x * z) * (1.f - c) - (y * s), 0},
+            {(x * y) * (1.f - c) - (z * s), y2 * (1.f - c) + c, (y * z) * (1.f - c) + (x * s), 0},
+            {(x * z) * (1.f - c) + (y * s), (y * z) * (1.f - c) - (x * s), z2 * (1.f - c) + c, 0},
+            {0, 0, 0, 1.f}
+        }
     };
-    glMultMatrixf(m);
+    mult_matrix(&m, MATRIX_TYPE_AFFINE);
 }
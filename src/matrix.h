@@ -1,9 +1,34 @@
+#pragma once
+
 #include <GLES/gl.h>
 
 // Matrix Common
 #define MATRIX_SIZE 4
 #define MATRIX_DATA_SIZE (sizeof (GLfloat) * MATRIX_SIZE * MATRIX_SIZE)
 // OpenGL Matrices Are Column-Major
+// Aligned So Columns Can Be Loaded Directly Into Vector Registers
+#define MATRIX_ALIGNMENT 16
 typedef struct {
     GLfloat data[MATRIX_SIZE][MATRIX_SIZE];
-} matrix_t;
+} __attribute__((aligned(MATRIX_ALIGNMENT))) matrix_t;
+
+// Identity Matrix
+extern matrix_t identity_matrix;
+
+// Multiply Matrices (out = a * b)
+// out May Alias a Or b
+void multiply_matrices(matrix_t *out, const matrix_t *a, const matrix_t *b);
+void multiply_matrices_scalar(matrix_t *out, const matrix_t *a, const matrix_t *b);
+
+// Matrix Types
+// Bits Are Only Ever Added, So A Type May Be More General Than The Matrix Itself
+#define MATRIX_TYPE_IDENTITY 0
+#define MATRIX_TYPE_TRANSLATE (1 << 0)
+#define MATRIX_TYPE_SCALE (1 << 1)
+// Any 3x3 Transformation
+#define MATRIX_TYPE_AFFINE (1 << 2)
+// Projective
+#define MATRIX_TYPE_GENERAL (1 << 3)
+int get_matrix_type(const matrix_t *m);
+// Skips Work Based On The Types Of The Inputs (Returns The Type Of The Result, out May Alias a But Not b)
+int multiply_typed_matrices(matrix_t *out, const matrix_t *a, int a_type, const matrix_t *b, int b_type);
@@ -1,130 +1,324 @@
 #include "passthrough.h"
+#include "context.h"
+#include "draw.h"
+#include "elements.h"
+#include "texture.h"
 
-// Get GL Function
-getProcAddress_t getProcAddress;
+// Redundant State Filtering
+#define SKIP_IF_UNCHANGED(bit, unchanged) \
+    if ((gl_state.server.known & (bit)) && (unchanged)) { \
+        return; \
+    } \
+    FLUSH_DRAWS(); \
+    gl_state.server.known |= (bit);
+#define RECTANGLE_UNCHANGED(rectangle) (rectangle.x == x && rectangle.y == y && rectangle.width == width && rectangle.height == height)
+#define SET_RECTANGLE(rectangle) \
+    { \
+        rectangle.x = x; \
+        rectangle.y = y; \
+        rectangle.width = width; \
+        rectangle.height = height; \
+    }
 
 // Simple v1.1 -> v2.0 Passthrough Functions
-GL_FUNC(glLineWidth, void, (GLfloat width));
+GL_FUNC(glLineWidth, void, ((GLfloat, width)));
 void glLineWidth(GLfloat width) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glLineWidth, (width));
+    FLUSH_DRAWS();
     real_glLineWidth()(width);
 }
-GL_FUNC(glBlendFunc, void, (GLenum sfactor, GLenum dfactor));
+GL_FUNC(glBlendFunc, void, ((GLenum, sfactor), (GLenum, dfactor)));
 void glBlendFunc(GLenum sfactor, GLenum dfactor) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glBlendFunc, (sfactor, dfactor));
+    SKIP_IF_UNCHANGED(SERVER_STATE_BLEND_FUNC, gl_state.server.blend_func.sfactor == sfactor && gl_state.server.blend_func.dfactor == dfactor);
+    gl_state.server.blend_func.sfactor = sfactor;
+    gl_state.server.blend_func.dfactor = dfactor;
     real_glBlendFunc()(sfactor, dfactor);
 }
-GL_FUNC(glClear, void, (GLbitfield mask));
+GL_FUNC(glClear, void, ((GLbitfield, mask)));
 void glClear(GLbitfield mask) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glClear, (mask));
+    FLUSH_DRAWS();
     real_glClear()(mask);
 }
-GL_FUNC(glBufferData, void, (GLenum target, GLsizeiptr size, const void *data, GLenum usage));
+GL_FUNC_COPY(glBufferData, void, ((GLenum, target), (GLsizeiptr, size), (const void *, data), (GLenum, usage)), ((data, size)));
 void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glBufferData, (target, size, data, usage));
+    FLUSH_DRAWS();
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        unbind_vertex_array_object();
+        element_buffer_data(get_element_array_buffer(), size, data);
+    }
     real_glBufferData()(target, size, data, usage);
 }
-GL_FUNC(glScissor, void, (GLint x, GLint y, GLsizei width, GLsizei height));
+GL_FUNC(glScissor, void, ((GLint, x), (GLint, y), (GLsizei, width), (GLsizei, height)));
 void glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glScissor, (x, y, width, height));
+    SKIP_IF_UNCHANGED(SERVER_STATE_SCISSOR, RECTANGLE_UNCHANGED(gl_state.server.scissor));
+    SET_RECTANGLE(gl_state.server.scissor);
     real_glScissor()(x, y, width, height);
 }
-GL_FUNC(glTexParameteri, void, (GLenum target, GLenum pname, GLint param));
+GL_FUNC(glTexParameteri, void, ((GLenum, target), (GLenum, pname), (GLint, param)));
 void glTexParameteri(GLenum target, GLenum pname, GLint param) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glTexParameteri, (target, pname, param));
+    FLUSH_DRAWS();
     real_glTexParameteri()(target, pname, param);
 }
-GL_FUNC(glTexImage2D, void, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels));
-void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels) {
-    real_glTexImage2D()(target, level, internalformat, width, height, border, format, type, pixels);
-}
-GL_FUNC(glPolygonOffset, void, (GLfloat factor, GLfloat units));
+GL_FUNC(glPolygonOffset, void, ((GLfloat, factor), (GLfloat, units)));
 void glPolygonOffset(GLfloat factor, GLfloat units) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glPolygonOffset, (factor, units));
+    FLUSH_DRAWS();
     real_glPolygonOffset()(factor, units);
 }
-GL_FUNC(glDepthRangef, void, (GLclampf near, GLclampf far));
+GL_FUNC(glDepthRangef, void, ((GLclampf, near), (GLclampf, far)));
 void glDepthRangef(GLclampf near, GLclampf far) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glDepthRangef, (near, far));
+    FLUSH_DRAWS();
     real_glDepthRangef()(near, far);
 }
-GL_FUNC(glBindBuffer, void, (GLenum target, GLuint buffer));
+GL_FUNC(glBindBuffer, void, ((GLenum, target), (GLuint, buffer)));
 void glBindBuffer(GLenum target, GLuint buffer) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glBindBuffer, (target, buffer));
+    if (target == GL_ARRAY_BUFFER) {
+        SKIP_IF_UNCHANGED(SERVER_STATE_ARRAY_BUFFER, gl_state.server.array_buffer == buffer);
+        gl_state.server.array_buffer = buffer;
+    } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        SKIP_IF_UNCHANGED(SERVER_STATE_ELEMENT_ARRAY_BUFFER, gl_state.server.element_array_buffer == buffer);
+        gl_state.server.element_array_buffer = buffer;
+        unbind_vertex_array_object();
+    } else {
+        FLUSH_DRAWS();
+    }
     real_glBindBuffer()(target, buffer);
 }
-GL_FUNC(glDepthFunc, void, (GLenum func));
+GL_FUNC(glDepthFunc, void, ((GLenum, func)));
 void glDepthFunc(GLenum func) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glDepthFunc, (func));
+    SKIP_IF_UNCHANGED(SERVER_STATE_DEPTH_FUNC, gl_state.server.depth_func == func);
+    gl_state.server.depth_func = func;
     real_glDepthFunc()(func);
 }
-GL_FUNC(glClearColor, void, (GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha));
+GL_FUNC(glClearColor, void, ((GLclampf, red), (GLclampf, green), (GLclampf, blue), (GLclampf, alpha)));
 void glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glClearColor, (red, green, blue, alpha));
+    FLUSH_DRAWS();
     real_glClearColor()(red, green, blue, alpha);
 }
-GL_FUNC(glDepthMask, void, (GLboolean flag));
+GL_FUNC(glDepthMask, void, ((GLboolean, flag)));
 void glDepthMask(GLboolean flag) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glDepthMask, (flag));
+    SKIP_IF_UNCHANGED(SERVER_STATE_DEPTH_MASK, gl_state.server.depth_mask == flag);
+    gl_state.server.depth_mask = flag;
     real_glDepthMask()(flag);
 }
-GL_FUNC(glHint, void, (GLenum target, GLenum mode));
+GL_FUNC(glHint, void, ((GLenum, target), (GLenum, mode)));
 void glHint(GLenum target, GLenum mode) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glHint, (target, mode));
     if (target != GL_PERSPECTIVE_CORRECTION_HINT) {
+        FLUSH_DRAWS();
         real_glHint()(target, mode);
     }
 }
-GL_FUNC(glDeleteBuffers, void, (GLsizei n, const GLuint *buffers));
+GL_FUNC_COPY(glDeleteBuffers, void, ((GLsizei, n), (const GLuint *, buffers)), ((buffers, n * sizeof (GLuint))));
 void glDeleteBuffers(GLsizei n, const GLuint *buffers) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glDeleteBuffers, (n, buffers));
+    FLUSH_DRAWS();
+    // Deleting A Bound Buffer Unbinds It
+    for (GLsizei i = 0; i < n; i++) {
+        if (buffers[i] != 0 && buffers[i] == gl_state.server.array_buffer) {
+            gl_state.server.array_buffer = 0;
+        }
+        if (buffers[i] != 0 && buffers[i] == gl_state.server.element_array_buffer) {
+            gl_state.server.element_array_buffer = 0;
+        }
+        delete_element_buffer(buffers[i]);
+    }
+    delete_vertex_array_buffers(n, buffers);
     real_glDeleteBuffers()(n, buffers);
 }
-GL_FUNC(glColorMask, void, (GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha));
+GL_FUNC(glColorMask, void, ((GLboolean, red), (GLboolean, green), (GLboolean, blue), (GLboolean, alpha)));
 void glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glColorMask, (red, green, blue, alpha));
+    SKIP_IF_UNCHANGED(SERVER_STATE_COLOR_MASK, gl_state.server.color_mask[0] == red && gl_state.server.color_mask[1] == green && gl_state.server.color_mask[2] == blue && gl_state.server.color_mask[3] == alpha);
+    gl_state.server.color_mask[0] = red;
+    gl_state.server.color_mask[1] = green;
+    gl_state.server.color_mask[2] = blue;
+    gl_state.server.color_mask[3] = alpha;
     real_glColorMask()(red, green, blue, alpha);
 }
-GL_FUNC(glTexSubImage2D, void, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels));
-void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels) {
-    real_glTexSubImage2D()(target, level, xoffset, yoffset, width, height, format, type, pixels);
-}
-GL_FUNC(glGenTextures, void, (GLsizei n, GLuint *textures));
+GL_FUNC_SYNC(glGenTextures, void, ((GLsizei, n), (GLuint *, textures)));
 void glGenTextures(GLsizei n, GLuint *textures) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE_SCOPE();
     real_glGenTextures()(n, textures);
+    CAPTURE_RESULT(glGenTextures, (n, textures));
 }
-GL_FUNC(glDeleteTextures, void, (GLsizei n, const GLuint *textures));
-void glDeleteTextures(GLsizei n, const GLuint *textures) {
-    real_glDeleteTextures()(n, textures);
-}
-GL_FUNC(glBindTexture, void, (GLenum target, GLuint texture));
+GL_FUNC(glBindTexture, void, ((GLenum, target), (GLuint, texture)));
 void glBindTexture(GLenum target, GLuint texture) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glBindTexture, (target, texture));
+    if (target == GL_TEXTURE_2D) {
+        SKIP_IF_UNCHANGED(SERVER_STATE_TEXTURE_2D, gl_state.server.texture_2d == texture);
+        gl_state.server.texture_2d = texture;
+    } else {
+        FLUSH_DRAWS();
+    }
     real_glBindTexture()(target, texture);
 }
-GL_FUNC(glCullFace, void, (GLenum mode));
+GL_FUNC(glCullFace, void, ((GLenum, mode)));
 void glCullFace(GLenum mode) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glCullFace, (mode));
+    SKIP_IF_UNCHANGED(SERVER_STATE_CULL_FACE, gl_state.server.cull_face == mode);
+    gl_state.server.cull_face = mode;
     real_glCullFace()(mode);
 }
-GL_FUNC(glViewport, void, (GLint x, GLint y, GLsizei width, GLsizei height));
+GL_FUNC(glViewport, void, ((GLint, x), (GLint, y), (GLsizei, width), (GLsizei, height)));
 void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glViewport, (x, y, width, height));
+    SKIP_IF_UNCHANGED(SERVER_STATE_VIEWPORT, RECTANGLE_UNCHANGED(gl_state.server.viewport));
+    SET_RECTANGLE(gl_state.server.viewport);
     real_glViewport()(x, y, width, height);
 }
-GL_FUNC(glIsEnabled, GLboolean, (GLenum cap));
+GL_FUNC_RETURN(glIsEnabled, GLboolean, ((GLenum, cap)));
 GLboolean glIsEnabled(GLenum cap) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glIsEnabled, (cap));
+    unsigned int bit = get_server_cap(cap);
+    if (gl_state.server.caps_known & bit) {
+        return !!(gl_state.server.caps_enabled & bit);
+    }
+    FLUSH_DRAWS();
     return real_glIsEnabled()(cap);
 }
-GL_FUNC(glGetIntegerv, void, (GLenum pname, GLint *data));
+GL_FUNC_SYNC(glGetIntegerv, void, ((GLenum, pname), (GLint *, data)));
 void glGetIntegerv(GLenum pname, GLint *data) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glGetIntegerv, (pname));
+    // Answer From The Shadow When Possible
+    switch (pname) {
+        case GL_ARRAY_BUFFER_BINDING: {
+            if (gl_state.server.known & SERVER_STATE_ARRAY_BUFFER) {
+                data[0] = gl_state.server.array_buffer;
+                return;
+            }
+            break;
+        }
+        case GL_ELEMENT_ARRAY_BUFFER_BINDING: {
+            if (gl_state.server.known & SERVER_STATE_ELEMENT_ARRAY_BUFFER) {
+                data[0] = gl_state.server.element_array_buffer;
+                return;
+            }
+            unbind_vertex_array_object();
+            break;
+        }
+        case GL_TEXTURE_BINDING_2D: {
+            if (gl_state.server.known & SERVER_STATE_TEXTURE_2D) {
+                data[0] = gl_state.server.texture_2d;
+                return;
+            }
+            break;
+        }
+        case GL_VIEWPORT: {
+            if (gl_state.server.known & SERVER_STATE_VIEWPORT) {
+                data[0] = gl_state.server.viewport.x;
+                data[1] = gl_state.server.viewport.y;
+                data[2] = gl_state.server.viewport.width;
+                data[3] = gl_state.server.viewport.height;
+                return;
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+    FLUSH_DRAWS();
     real_glGetIntegerv()(pname, data);
 }
-GL_FUNC(glReadPixels, void, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *data));
+GL_FUNC_SYNC(glReadPixels, void, ((GLint, x), (GLint, y), (GLsizei, width), (GLsizei, height), (GLenum, format), (GLenum, type), (void *, data)));
 void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *data) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glReadPixels, (x, y, width, height, format, type));
+    FLUSH_DRAWS();
     real_glReadPixels()(x, y, width, height, format, type, data);
 }
 void glShadeModel(__attribute__((unused)) GLenum mode) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glShadeModel, (mode));
     // Do Nothing
 }
-GL_FUNC(glGenBuffers, void, (GLsizei n, GLuint *buffers));
+GL_FUNC_SYNC(glGenBuffers, void, ((GLsizei, n), (GLuint *, buffers)));
 void glGenBuffers(GLsizei n, GLuint *buffers) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE_SCOPE();
     real_glGenBuffers()(n, buffers);
+    CAPTURE_RESULT(glGenBuffers, (n, buffers));
 }
-GL_FUNC(glGetError, GLenum, ());
+GL_FUNC_RETURN(glGetError, GLenum, ());
 GLenum glGetError() {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glGetError, ());
+    FLUSH_DRAWS();
 	return real_glGetError()();
 }
-GL_FUNC(glBufferSubData, void, (GLenum target, GLintptr offset, GLsizeiptr size, const void *data));
+GL_FUNC_COPY(glBufferSubData, void, ((GLenum, target), (GLintptr, offset), (GLsizeiptr, size), (const void *, data)), ((data, size)));
 void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glBufferSubData, (target, offset, size, data));
+    FLUSH_DRAWS();
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        unbind_vertex_array_object();
+        element_buffer_sub_data(get_element_array_buffer(), offset, size, data);
+    }
     real_glBufferSubData()(target, offset, size, data);
 }
-GL_FUNC(glPixelStorei, void, (GLenum pname, GLint param));
+GL_FUNC(glPixelStorei, void, ((GLenum, pname), (GLint, param)));
 void glPixelStorei(GLenum pname, GLint param) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glPixelStorei, (pname, param));
+    FLUSH_DRAWS();
+    if (pname == GL_UNPACK_ALIGNMENT) {
+        gl_state.unpack_alignment = param;
+    }
     real_glPixelStorei()(pname, param);
 }
 void glNormal3f(__attribute__((unused)) GLfloat nx, __attribute__((unused)) GLfloat ny, __attribute__((unused)) GLfloat nz) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glNormal3f, (nx, ny, nz));
     // Ignore
 }
+GL_FUNC(glFlush, void, ());
+void glFlush() {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glFlush, ());
+    FLUSH_DRAWS();
+    flush_all_texture_uploads();
+    poll_programs();
+    real_glFlush()();
+}
+GL_FUNC_SYNC(glFinish, void, ());
+void glFinish() {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glFinish, ());
+    FLUSH_DRAWS();
+    flush_all_texture_uploads();
+    poll_programs();
+    real_glFinish()();
+}
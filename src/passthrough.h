@@ -1,6 +1,12 @@
+#pragma once
+
+#include <string.h>
+
 #include <GLES/gl.h>
 
 #include "log.h"
+#include "thread.h"
+#include "instrumentation.h"
 
 // Testing
 #ifdef GLES_COMPATIBILITY_LAYER_TESTING
@@ -14,24 +20,112 @@ extern void add_test(const char *function_name);
 #define ADD_TEST(test)
 #endif
 
+// Argument Lists
+// Arguments Are Written As ((type, name), ...) So They Can Be Stored In Queued Calls
+#define GL_STRIP(...) __VA_ARGS__
+#define GL_CONCAT_(a, b) a##b
+#define GL_CONCAT(a, b) GL_CONCAT_(a, b)
+#define GL_COUNT(...) GL_COUNT_(_, ##__VA_ARGS__, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define GL_COUNT_(_, _1, _2, _3, _4, _5, _6, _7, _8, _9, n, ...) n
+#define GL_FOR_EACH(m, sep, ...) GL_FOR_EACH_N(GL_COUNT(__VA_ARGS__), m, sep, __VA_ARGS__)
+#define GL_FOR_EACH_N(n, m, sep, ...) GL_CONCAT(GL_FOR_EACH_, n)(m, sep, ##__VA_ARGS__)
+#define GL_FOR_EACH_0(m, sep, ...)
+#define GL_FOR_EACH_1(m, sep, x) m x
+#define GL_FOR_EACH_2(m, sep, x, ...) m x sep() GL_FOR_EACH_1(m, sep, __VA_ARGS__)
+#define GL_FOR_EACH_3(m, sep, x, ...) m x sep() GL_FOR_EACH_2(m, sep, __VA_ARGS__)
+#define GL_FOR_EACH_4(m, sep, x, ...) m x sep() GL_FOR_EACH_3(m, sep, __VA_ARGS__)
+#define GL_FOR_EACH_5(m, sep, x, ...) m x sep() GL_FOR_EACH_4(m, sep, __VA_ARGS__)
+#define GL_FOR_EACH_6(m, sep, x, ...) m x sep() GL_FOR_EACH_5(m, sep, __VA_ARGS__)
+#define GL_FOR_EACH_7(m, sep, x, ...) m x sep() GL_FOR_EACH_6(m, sep, __VA_ARGS__)
+#define GL_FOR_EACH_8(m, sep, x, ...) m x sep() GL_FOR_EACH_7(m, sep, __VA_ARGS__)
+#define GL_FOR_EACH_9(m, sep, x, ...) m x sep() GL_FOR_EACH_8(m, sep, __VA_ARGS__)
+#define GL_COMMA() ,
+#define GL_NOTHING()
+#define GL_PARAM(type, name) type name
+#define GL_ARG(type, name) name
+#define GL_FIELD(type, name) type name;
+#define GL_STORE_ARG(type, name) cmd->name = name;
+#define GL_CMD_ARG(type, name) cmd->name
+#define GL_PARAMS(args) GL_FOR_EACH(GL_PARAM, GL_COMMA, GL_STRIP args)
+#define GL_ARGS(args) GL_FOR_EACH(GL_ARG, GL_COMMA, GL_STRIP args)
+#define GL_CMD_ARGS(args) GL_FOR_EACH(GL_CMD_ARG, GL_COMMA, GL_STRIP args)
+// Payloads Are Written As ((argument, size), ...)
+#define GL_PAYLOAD_SIZE(name, size) + QUEUED_ALIGN((name) != NULL ? (size_t) (size) : 0)
+#define GL_COPY_PAYLOAD(name, size) \
+    if (name != NULL) { \
+        memcpy(payload, name, size); \
+        cmd->name = (void *) payload; \
+        payload += QUEUED_ALIGN(size); \
+    }
+
 // Load GL Function
-extern getProcAddress_t getProcAddress;
 #if defined(_WIN32) && !defined(_WIN32_WCE) && !defined(__SCITECH_SNAP__)
 #define GL_APIENTRY __stdcall
 #else
 #define GL_APIENTRY
 #endif
-#define GL_FUNC(name, return_type, args) \
-    typedef return_type (GL_APIENTRY *real_##name##_t)args; \
+#include "dispatch.h"
+#include "capture.h"
+#define GL_FUNC_BASE(name, return_type, args, queued_call) \
+    struct queued_##name { \
+        GL_FOR_EACH(GL_FIELD, GL_NOTHING, GL_STRIP args) \
+        return_type *result; \
+    }; \
+    static void run_##name(void *data) { \
+        struct queued_##name *cmd = data; \
+        (void) cmd; \
+        queued_call; \
+    } \
     \
-    real_##name##_t real_##name() { \
-        static real_##name##_t func = NULL; \
-        if (!func) { \
-            func = (real_##name##_t) getProcAddress(#name); \
-            if (!func) { \
-                ERR("Error Resolving GL Symbol: " #name); \
-            } \
-        } \
-        return func; \
+    /* The Assignment Also Checks The Signature Against The Dispatch Table */ \
+    __attribute__((constructor)) static void register_##name() { \
+        gl_queue_dispatch.name = queue_##name; \
     } \
     ADD_TEST(name)
+// Queued Asynchronously
+#define GL_FUNC(name, return_type, args) GL_FUNC_COPY(name, return_type, args, ())
+// Queued Asynchronously, Copying Pointed-To Data
+#define GL_FUNC_COPY(name, return_type, args, payloads) \
+    static return_type GL_APIENTRY queue_##name(GL_PARAMS(args)); \
+    GL_FUNC_BASE(name, return_type, args, real_##name()(GL_CMD_ARGS(args))) \
+    static return_type GL_APIENTRY queue_##name(GL_PARAMS(args)) { \
+        const size_t payload_size = 0 GL_FOR_EACH(GL_PAYLOAD_SIZE, GL_NOTHING, GL_STRIP payloads); \
+        if (payload_size > MAX_QUEUED_PAYLOAD_SIZE) { \
+            struct queued_##name *cmd = begin_queued_call(run_##name, sizeof (struct queued_##name)); \
+            GL_FOR_EACH(GL_STORE_ARG, GL_NOTHING, GL_STRIP args) \
+            (void) cmd; \
+            end_queued_call(); \
+            wait_for_queued_calls(); \
+            return; \
+        } \
+        struct queued_##name *cmd = begin_queued_call(run_##name, QUEUED_ALIGN(sizeof (struct queued_##name)) + payload_size); \
+        GL_FOR_EACH(GL_STORE_ARG, GL_NOTHING, GL_STRIP args) \
+        unsigned char *payload = ((unsigned char *) cmd) + QUEUED_ALIGN(sizeof (struct queued_##name)); \
+        (void) payload; \
+        GL_FOR_EACH(GL_COPY_PAYLOAD, GL_NOTHING, GL_STRIP payloads) \
+        end_queued_call(); \
+    }
+// Queued And Waited For (Used When Arguments Point To Outputs)
+#define GL_FUNC_SYNC(name, return_type, args) \
+    static return_type GL_APIENTRY queue_##name(GL_PARAMS(args)); \
+    GL_FUNC_BASE(name, return_type, args, real_##name()(GL_CMD_ARGS(args))) \
+    static return_type GL_APIENTRY queue_##name(GL_PARAMS(args)) { \
+        struct queued_##name *cmd = begin_queued_call(run_##name, sizeof (struct queued_##name)); \
+        GL_FOR_EACH(GL_STORE_ARG, GL_NOTHING, GL_STRIP args) \
+        (void) cmd; \
+        end_queued_call(); \
+        wait_for_queued_calls(); \
+    }
+// Queued And Waited For, Returning A Value
+#define GL_FUNC_RETURN(name, return_type, args) \
+    static return_type GL_APIENTRY queue_##name(GL_PARAMS(args)); \
+    GL_FUNC_BASE(name, return_type, args, *cmd->result = real_##name()(GL_CMD_ARGS(args))) \
+    static return_type GL_APIENTRY queue_##name(GL_PARAMS(args)) { \
+        return_type result; \
+        struct queued_##name *cmd = begin_queued_call(run_##name, sizeof (struct queued_##name)); \
+        GL_FOR_EACH(GL_STORE_ARG, GL_NOTHING, GL_STRIP args) \
+        cmd->result = &result; \
+        end_queued_call(); \
+        wait_for_queued_calls(); \
+        return result; \
+    }
@@ -0,0 +1,92 @@
+#include "primitives.h"
+#include "log.h"
+
+// Get The List Primitive A Mode Is Converted To
+GLenum get_list_primitive(const GLenum mode) {
+    switch (mode) {
+        case GL_POINTS: {
+            return GL_POINTS;
+        }
+        case GL_LINES:
+        case GL_LINE_STRIP:
+        case GL_LINE_LOOP: {
+            return GL_LINES;
+        }
+        case GL_TRIANGLES:
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:
+        case GL_QUADS:
+        case GL_QUAD_STRIP:
+        case GL_POLYGON: {
+            return GL_TRIANGLES;
+        }
+        default: {
+            ERR("Unsupported Primitive: %i", mode);
+        }
+    }
+}
+
+// Emit The Vertices Of Each Primitive In List Order
+#define emit_triangle(a, b, c) \
+    { \
+        emit(data, first + (a)); \
+        emit(data, first + (b)); \
+        emit(data, first + (c)); \
+    }
+void assemble_primitives(const GLenum mode, const GLint first, const GLsizei count, void (*emit)(void *data, GLint index), void *data) {
+    switch (mode) {
+        case GL_POINTS:
+        case GL_LINES:
+        case GL_TRIANGLES: {
+            // Incomplete Primitives Are Dropped
+            const GLsizei vertices_per_primitive = mode == GL_TRIANGLES ? 3 : (mode == GL_LINES ? 2 : 1);
+            for (GLsizei i = 0; i < count - (count % vertices_per_primitive); i++) {
+                emit(data, first + i);
+            }
+            break;
+        }
+        case GL_LINE_STRIP:
+        case GL_LINE_LOOP: {
+            for (GLsizei i = 0; i + 1 < count; i++) {
+                emit(data, first + i);
+                emit(data, first + i + 1);
+            }
+            if (mode == GL_LINE_LOOP && count > 1) {
+                emit(data, first + count - 1);
+                emit(data, first);
+            }
+            break;
+        }
+        case GL_TRIANGLE_STRIP: {
+            // Preserve Winding
+            for (GLsizei i = 0; i + 2 < count; i++) {
+                emit_triangle(i + (i % 2), i + 1 - (i % 2), i + 2);
+            }
+            break;
+        }
+        case GL_TRIANGLE_FAN:
+        case GL_POLYGON: {
+            for (GLsizei i = 1; i + 1 < count; i++) {
+                emit_triangle(0, i, i + 1);
+            }
+            break;
+        }
+        case GL_QUADS: {
+            for (GLsizei i = 0; i + 3 < count; i += 4) {
+                emit_triangle(i, i + 1, i + 2);
+                emit_triangle(i, i + 2, i + 3);
+            }
+            break;
+        }
+        case GL_QUAD_STRIP: {
+            for (GLsizei i = 0; i + 3 < count; i += 2) {
+                emit_triangle(i, i + 1, i + 3);
+                emit_triangle(i, i + 3, i + 2);
+            }
+            break;
+        }
+        default: {
+            ERR("Unsupported Primitive: %i", mode);
+        }
+    }
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <GLES/gl.h>
+
+// Primitive Assembly
+// Strips, Fans, Loops, Quads And Polygons Are Converted To Lists So Consecutive Draws Can Be Merged
+GLenum get_list_primitive(GLenum mode);
+void assemble_primitives(GLenum mode, GLint first, GLsizei count, void (*emit)(void *data, GLint index), void *data);
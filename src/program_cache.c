@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "program_cache.h"
+#include "context.h"
+#include "log.h"
+
+// Constants
+#define REAL_GL_PROGRAM_BINARY_LENGTH_OES 0x8741
+#define REAL_GL_NUM_PROGRAM_BINARY_FORMATS_OES 0x87fe
+#define REAL_GL_PROGRAM_BINARY_FORMATS_OES 0x87ff
+
+// Functions
+GL_FUNC_SYNC(glGetProgramiv, void, ((GLuint, program), (GLenum, pname), (GLint *, params)));
+GL_FUNC_SYNC(glGetProgramBinaryOES, void, ((GLuint, program), (GLsizei, bufSize), (GLsizei *, length), (GLenum *, binaryFormat), (void *, binary)));
+GL_FUNC_COPY(glProgramBinaryOES, void, ((GLuint, program), (GLenum, binaryFormat), (const void *, binary), (GLint, length)), ((binary, length)));
+
+// File Format
+// Bump The Version Whenever The Layer Changes How Programs Are Built (Attribute Bindings, Defines)
+#define PROGRAM_CACHE_MAGIC 0x4c434c47
+#define PROGRAM_CACHE_VERSION 1
+#define MAX_PROGRAM_BINARY_LENGTH (64 * 1024 * 1024)
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t length;
+    uint64_t checksum;
+} program_cache_header_t;
+
+// State
+// The Directory Is Shared By All Contexts, Driver Support Is Per Context
+static char *directory = NULL;
+#define program_cache (current_context->program_cache)
+void set_gles_compatibility_layer_program_cache(const char *path) {
+    free(directory);
+    directory = NULL;
+    if (path != NULL) {
+        directory = strdup(path);
+        ALLOC_CHECK(directory);
+    }
+}
+
+// FNV-1a
+static uint64_t hash_data(uint64_t hash, const void *data, const size_t size) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+#define HASH_INIT 0xcbf29ce484222325ull
+static uint64_t hash_string(const uint64_t hash, const char *string) {
+    // Include The Terminator So Adjacent Strings Cannot Run Together
+    return string != NULL ? hash_data(hash, string, strlen(string) + 1) : hash_data(hash, "", 1);
+}
+
+// Init
+void _init_gles_compatibility_layer_program_cache(const char *extensions, const char *renderer, const char *version) {
+    // Check Support
+    if (extensions != NULL && strstr(extensions, "GL_OES_get_program_binary") != NULL && HAS_GL_FUNC(glGetProgramBinaryOES) && HAS_GL_FUNC(glProgramBinaryOES)) {
+        glGetIntegerv(REAL_GL_NUM_PROGRAM_BINARY_FORMATS_OES, &program_cache.formats_size);
+        if (program_cache.formats_size > 0) {
+            program_cache.formats = malloc(program_cache.formats_size * sizeof (GLint));
+            ALLOC_CHECK(program_cache.formats);
+            glGetIntegerv(REAL_GL_PROGRAM_BINARY_FORMATS_OES, program_cache.formats);
+            program_cache.supported = 1;
+        } else {
+            program_cache.formats_size = 0;
+        }
+    }
+
+    // Binaries Are Only Valid For The Driver That Produced Them
+    uint64_t key = HASH_INIT;
+    const uint32_t cache_version = PROGRAM_CACHE_VERSION;
+    key = hash_data(key, &cache_version, sizeof (cache_version));
+    key = hash_string(key, renderer);
+    key = hash_string(key, version);
+    program_cache.driver_key = key;
+}
+void _free_gles_compatibility_layer_program_cache() {
+    free(program_cache.formats);
+}
+
+// Cache Keys
+uint64_t get_program_cache_key(const char *const *strings, const size_t *lengths, const int count) {
+    uint64_t key = program_cache.driver_key;
+    for (int i = 0; i < count; i++) {
+        key = hash_data(key, &lengths[i], sizeof (lengths[i]));
+        key = hash_data(key, strings[i], lengths[i]);
+    }
+    return key;
+}
+
+// Files
+static int is_enabled() {
+    return directory != NULL && program_cache.supported;
+}
+static char *get_path(const uint64_t key, const char *suffix) {
+    const size_t size = strlen(directory) + 32 + strlen(suffix);
+    char *path = malloc(size);
+    ALLOC_CHECK(path);
+    snprintf(path, size, "%s/%016llx%s", directory, (unsigned long long) key, suffix);
+    return path;
+}
+static int is_supported_format(const GLenum format) {
+    for (GLint i = 0; i < program_cache.formats_size; i++) {
+        if ((GLenum) program_cache.formats[i] == format) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Load
+int load_program_binary(const GLuint program, const uint64_t key) {
+    if (!is_enabled()) {
+        return 0;
+    }
+
+    // Read
+    char *path = get_path(key, ".bin");
+    FILE *file = fopen(path, "rb");
+    free(path);
+    if (file == NULL) {
+        return 0;
+    }
+    program_cache_header_t header;
+    void *binary = NULL;
+    int valid = fread(&header, sizeof (header), 1, file) == 1;
+    valid = valid && header.magic == PROGRAM_CACHE_MAGIC && header.version == PROGRAM_CACHE_VERSION && header.key == key;
+    valid = valid && header.length > 0 && header.length <= MAX_PROGRAM_BINARY_LENGTH && is_supported_format(header.format);
+    if (valid) {
+        binary = malloc(header.length);
+        ALLOC_CHECK(binary);
+        valid = fread(binary, header.length, 1, file) == 1 && hash_data(HASH_INIT, binary, header.length) == header.checksum;
+    }
+    fclose(file);
+
+    // Load (The Driver May Still Reject It)
+    if (valid) {
+        real_glProgramBinaryOES()(program, header.format, binary, header.length);
+    }
+    free(binary);
+    return valid;
+}
+
+// Save
+void save_program_binary(const GLuint program, const uint64_t key) {
+    if (!is_enabled()) {
+        return;
+    }
+
+    // Get Binary
+    GLint length = 0;
+    real_glGetProgramiv()(program, REAL_GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length <= 0 || length > MAX_PROGRAM_BINARY_LENGTH) {
+        return;
+    }
+    void *binary = malloc(length);
+    ALLOC_CHECK(binary);
+    GLenum format = 0;
+    GLsizei binary_length = 0;
+    real_glGetProgramBinaryOES()(program, length, &binary_length, &format, binary);
+    if (binary_length <= 0) {
+        free(binary);
+        return;
+    }
+    const program_cache_header_t header = {
+        .magic = PROGRAM_CACHE_MAGIC,
+        .version = PROGRAM_CACHE_VERSION,
+        .key = key,
+        .format = format,
+        .length = binary_length,
+        .checksum = hash_data(HASH_INIT, binary, binary_length)
+    };
+
+    // Write To A Temporary File And Rename, So Other Processes Never See A Partial File
+    char suffix[32];
+    snprintf(suffix, sizeof (suffix), ".%li.tmp", (long) getpid());
+    char *temporary_path = get_path(key, suffix);
+    char *path = get_path(key, ".bin");
+    FILE *file = fopen(temporary_path, "wb");
+    if (file != NULL) {
+        int written = fwrite(&header, sizeof (header), 1, file) == 1 && fwrite(binary, binary_length, 1, file) == 1;
+        written = fclose(file) == 0 && written;
+        if (!written || rename(temporary_path, path) != 0) {
+            remove(temporary_path);
+        }
+    }
+    free(temporary_path);
+    free(path);
+    free(binary);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <GLES/gl.h>
+
+// Program Binary Cache
+// Linked Programs Are Saved With GL_OES_get_program_binary And Loaded Instead Of Compiled On Later Launches
+typedef struct {
+    int supported;
+    uint64_t driver_key;
+    GLint *formats;
+    GLint formats_size;
+} program_cache_context_t;
+void _init_gles_compatibility_layer_program_cache(const char *extensions, const char *renderer, const char *version);
+void _free_gles_compatibility_layer_program_cache();
+
+// Hash Of The Given Sources Combined With The Driver Identification
+uint64_t get_program_cache_key(const char *const *strings, const size_t *lengths, int count);
+
+// Returns Whether A Binary Was Found And Passed To The Driver (Its Link Status Must Still Be Checked)
+int load_program_binary(GLuint program, uint64_t key);
+// Saves A Successfully Linked Program
+void save_program_binary(GLuint program, uint64_t key);
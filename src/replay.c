@@ -0,0 +1,447 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "passthrough.h"
+#include "texture.h"
+#include "log.h"
+
+// Object Names
+// The Replaying Driver May Hand Out Different Names, So Captured Names Are Translated (Unknown Names Are Used As-Is)
+typedef struct {
+    GLuint *names;
+    GLuint size;
+} name_map_t;
+static void set_name(name_map_t *map, const GLuint captured, const GLuint name) {
+    if (captured >= map->size) {
+        const GLuint new_size = (captured + 1) * 2;
+        map->names = realloc(map->names, new_size * sizeof (GLuint));
+        ALLOC_CHECK(map->names);
+        memset(map->names + map->size, 0, (new_size - map->size) * sizeof (GLuint));
+        map->size = new_size;
+    }
+    map->names[captured] = name;
+}
+static GLuint get_name(const name_map_t *map, const GLuint captured) {
+    return captured < map->size && map->names[captured] != 0 ? map->names[captured] : captured;
+}
+
+// State
+typedef struct {
+    // Payloads Point Into The Mapped File
+    const unsigned char **payloads;
+    uint32_t payloads_size;
+    uint32_t payloads_capacity;
+    name_map_t textures;
+    name_map_t buffers;
+    name_map_t lists;
+    // Scratch Memory For Names And Query Results
+    void *scratch;
+    size_t scratch_size;
+} replay_t;
+static void *get_scratch(replay_t *replay, const size_t size) {
+    if (size > replay->scratch_size) {
+        replay->scratch_size = size;
+        replay->scratch = realloc(replay->scratch, replay->scratch_size);
+        ALLOC_CHECK(replay->scratch);
+    }
+    return replay->scratch;
+}
+
+// Reading
+typedef struct {
+    const unsigned char *data;
+    const unsigned char *end;
+} reader_t;
+static const void *read_data(reader_t *reader, const size_t size) {
+    if ((size_t) (reader->end - reader->data) < size) {
+        ERR("Corrupt Capture");
+    }
+    const void *data = reader->data;
+    reader->data += size;
+    return data;
+}
+static uint32_t read_uint(reader_t *reader) {
+    uint32_t value;
+    memcpy(&value, read_data(reader, sizeof (value)), sizeof (value));
+    return value;
+}
+static GLfloat read_float(reader_t *reader) {
+    GLfloat value;
+    memcpy(&value, read_data(reader, sizeof (value)), sizeof (value));
+    return value;
+}
+static int64_t read_int64(reader_t *reader) {
+    int64_t value;
+    memcpy(&value, read_data(reader, sizeof (value)), sizeof (value));
+    return value;
+}
+static const void *read_payload(const replay_t *replay, reader_t *reader) {
+    const uint32_t index = read_uint(reader);
+    if (index == CAPTURE_NO_PAYLOAD) {
+        return NULL;
+    }
+    if (index >= replay->payloads_size) {
+        ERR("Corrupt Capture");
+    }
+    return replay->payloads[index];
+}
+#define REPLAY_ARG(type, name) const type name = _Generic((type) 0, GLfloat: read_float, default: read_uint)(reader);
+
+// Arrays Stored In The Record
+static const GLuint *read_names(replay_t *replay, reader_t *reader, const name_map_t *map, GLsizei *n) {
+    *n = read_uint(reader);
+    const unsigned char *captured = read_data(reader, *n * sizeof (GLuint));
+    GLuint *names = get_scratch(replay, *n * sizeof (GLuint));
+    for (GLsizei i = 0; i < *n; i++) {
+        GLuint name;
+        memcpy(&name, captured + (i * sizeof (GLuint)), sizeof (name));
+        names[i] = map != NULL ? get_name(map, name) : name;
+    }
+    return names;
+}
+static void read_floats(reader_t *reader, GLfloat *out, const int count) {
+    for (int i = 0; i < count; i++) {
+        out[i] = read_float(reader);
+    }
+}
+
+// Generated Functions
+#define REPLAY_FUNCTION(name, args) \
+    case CAPTURE_##name: { \
+        GL_FOR_EACH(REPLAY_ARG, GL_NOTHING, GL_STRIP args) \
+        name(GL_ARGS(args)); \
+        break; \
+    }
+#define REPLAY_IGNORE(name)
+
+// Client-Side Arrays
+static void replay_client_array(replay_t *replay, reader_t *reader) {
+    const GLenum array = read_uint(reader);
+    const GLint size = read_uint(reader);
+    const GLenum type = read_uint(reader);
+    const GLsizei stride = read_uint(reader);
+    const void *pointer = read_payload(replay, reader);
+    // Pointers Are Only Client-Side While No Array Buffer Is Bound
+    GLint buffer;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &buffer);
+    if (buffer != 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    switch (array) {
+        case GL_VERTEX_ARRAY: {
+            glVertexPointer(size, type, stride, pointer);
+            break;
+        }
+        case GL_COLOR_ARRAY: {
+            glColorPointer(size, type, stride, pointer);
+            break;
+        }
+        case GL_TEXTURE_COORD_ARRAY: {
+            glTexCoordPointer(size, type, stride, pointer);
+            break;
+        }
+        default: {
+            ERR("Corrupt Capture");
+        }
+    }
+    if (buffer != 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    }
+}
+
+// Run One Record
+static void replay_record(replay_t *replay, const uint32_t record_type, reader_t *reader) {
+    switch (record_type) {
+        CAPTURE_FUNCTIONS(REPLAY_FUNCTION, REPLAY_IGNORE)
+        case CAPTURE_CLIENT_ARRAY: {
+            replay_client_array(replay, reader);
+            break;
+        }
+
+        // Object Names
+        case CAPTURE_glGenTextures:
+        case CAPTURE_glGenBuffers: {
+            GLsizei n;
+            const GLuint *captured = read_names(replay, reader, NULL, &n);
+            GLuint *names = malloc(n * sizeof (GLuint));
+            ALLOC_CHECK(names);
+            name_map_t *map = record_type == CAPTURE_glGenTextures ? &replay->textures : &replay->buffers;
+            if (record_type == CAPTURE_glGenTextures) {
+                glGenTextures(n, names);
+            } else {
+                glGenBuffers(n, names);
+            }
+            for (GLsizei i = 0; i < n; i++) {
+                set_name(map, captured[i], names[i]);
+            }
+            free(names);
+            break;
+        }
+        case CAPTURE_glDeleteTextures: {
+            GLsizei n;
+            const GLuint *names = read_names(replay, reader, &replay->textures, &n);
+            glDeleteTextures(n, names);
+            break;
+        }
+        case CAPTURE_glDeleteBuffers: {
+            GLsizei n;
+            const GLuint *names = read_names(replay, reader, &replay->buffers, &n);
+            glDeleteBuffers(n, names);
+            break;
+        }
+        case CAPTURE_glBindTexture: {
+            const GLenum target = read_uint(reader);
+            glBindTexture(target, get_name(&replay->textures, read_uint(reader)));
+            break;
+        }
+        case CAPTURE_glBindBuffer: {
+            const GLenum target = read_uint(reader);
+            glBindBuffer(target, get_name(&replay->buffers, read_uint(reader)));
+            break;
+        }
+
+        // Buffers
+        case CAPTURE_glBufferData: {
+            const GLenum target = read_uint(reader);
+            const GLsizeiptr size = read_int64(reader);
+            const void *data = read_payload(replay, reader);
+            glBufferData(target, size, data, read_uint(reader));
+            break;
+        }
+        case CAPTURE_glBufferSubData: {
+            const GLenum target = read_uint(reader);
+            const GLintptr offset = read_int64(reader);
+            const GLsizeiptr size = read_int64(reader);
+            glBufferSubData(target, offset, size, read_payload(replay, reader));
+            break;
+        }
+
+        // Textures
+        case CAPTURE_glTexImage2D: {
+            const GLenum target = read_uint(reader);
+            const GLint level = read_uint(reader);
+            const GLint internalformat = read_uint(reader);
+            const GLsizei width = read_uint(reader);
+            const GLsizei height = read_uint(reader);
+            const GLint border = read_uint(reader);
+            const GLenum format = read_uint(reader);
+            const GLenum type = read_uint(reader);
+            glTexImage2D(target, level, internalformat, width, height, border, format, type, read_payload(replay, reader));
+            break;
+        }
+        case CAPTURE_glTexSubImage2D: {
+            const GLenum target = read_uint(reader);
+            const GLint level = read_uint(reader);
+            const GLint xoffset = read_uint(reader);
+            const GLint yoffset = read_uint(reader);
+            const GLsizei width = read_uint(reader);
+            const GLsizei height = read_uint(reader);
+            const GLenum format = read_uint(reader);
+            const GLenum type = read_uint(reader);
+            glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, read_payload(replay, reader));
+            break;
+        }
+
+        // Queries
+        case CAPTURE_glGetIntegerv: {
+            glGetIntegerv(read_uint(reader), get_scratch(replay, 16 * sizeof (GLint)));
+            break;
+        }
+        case CAPTURE_glGetFloatv: {
+            glGetFloatv(read_uint(reader), get_scratch(replay, 16 * sizeof (GLfloat)));
+            break;
+        }
+        case CAPTURE_glReadPixels: {
+            const GLint x = read_uint(reader);
+            const GLint y = read_uint(reader);
+            const GLsizei width = read_uint(reader);
+            const GLsizei height = read_uint(reader);
+            const GLenum format = read_uint(reader);
+            const GLenum type = read_uint(reader);
+            // Rows May Be Padded To Any Pack Alignment
+            size_t size = get_image_size(width, height, format, type);
+            if (size == UNKNOWN_IMAGE_SIZE) {
+                // Large Enough For Four Floats Per Pixel
+                size = (size_t) width * height * 16;
+            }
+            glReadPixels(x, y, width, height, format, type, get_scratch(replay, size + (height * 8)));
+            break;
+        }
+
+        // State
+        case CAPTURE_glFogfv: {
+            const GLenum pname = read_uint(reader);
+            GLfloat params[4];
+            read_floats(reader, params, pname == GL_FOG_COLOR ? 4 : 1);
+            glFogfv(pname, params);
+            break;
+        }
+        case CAPTURE_glMultMatrixf: {
+            GLfloat m[16];
+            read_floats(reader, m, 16);
+            glMultMatrixf(m);
+            break;
+        }
+        case CAPTURE_glVertexPointer:
+        case CAPTURE_glColorPointer:
+        case CAPTURE_glTexCoordPointer: {
+            const GLint size = read_uint(reader);
+            const GLenum type = read_uint(reader);
+            const GLsizei stride = read_uint(reader);
+            const void *pointer = (const void *) (intptr_t) read_int64(reader);
+            if (record_type == CAPTURE_glVertexPointer) {
+                glVertexPointer(size, type, stride, pointer);
+            } else if (record_type == CAPTURE_glColorPointer) {
+                glColorPointer(size, type, stride, pointer);
+            } else {
+                glTexCoordPointer(size, type, stride, pointer);
+            }
+            break;
+        }
+
+        // Drawing
+        case CAPTURE_glDrawArrays: {
+            const GLenum mode = read_uint(reader);
+            const GLint first = read_uint(reader);
+            glDrawArrays(mode, first, read_uint(reader));
+            break;
+        }
+        case CAPTURE_glMultiDrawArrays: {
+            const GLenum mode = read_uint(reader);
+            const GLsizei drawcount = read_uint(reader);
+            const GLint *first = read_data(reader, drawcount * sizeof (GLint));
+            const GLsizei *count = read_data(reader, drawcount * sizeof (GLsizei));
+            glMultiDrawArrays(mode, first, count, drawcount);
+            break;
+        }
+        case CAPTURE_glDrawElements: {
+            const GLenum mode = read_uint(reader);
+            const GLsizei count = read_uint(reader);
+            const GLenum type = read_uint(reader);
+            const void *indices = read_payload(replay, reader);
+            const int64_t offset = read_int64(reader);
+            glDrawElements(mode, count, type, indices != NULL ? indices : (const void *) (intptr_t) offset);
+            break;
+        }
+
+        // Display Lists
+        case CAPTURE_glGenLists: {
+            const GLsizei range = read_uint(reader);
+            const GLuint captured = read_uint(reader);
+            const GLuint first = glGenLists(range);
+            for (GLsizei i = 0; i < range; i++) {
+                set_name(&replay->lists, captured + i, first + i);
+            }
+            break;
+        }
+        case CAPTURE_glDeleteLists: {
+            const GLuint list = read_uint(reader);
+            const GLsizei range = read_uint(reader);
+            for (GLsizei i = 0; i < range; i++) {
+                glDeleteLists(get_name(&replay->lists, list + i), 1);
+            }
+            break;
+        }
+        case CAPTURE_glNewList: {
+            const GLuint list = read_uint(reader);
+            glNewList(get_name(&replay->lists, list), read_uint(reader));
+            break;
+        }
+        case CAPTURE_glCallList: {
+            glCallList(get_name(&replay->lists, read_uint(reader)));
+            break;
+        }
+        case CAPTURE_glCallLists: {
+            GLsizei n;
+            const GLuint *names = read_names(replay, reader, &replay->lists, &n);
+            glCallLists(n, GL_UNSIGNED_INT, names);
+            break;
+        }
+
+        default: {
+            ERR("Unknown Capture Record: %u", record_type);
+        }
+    }
+}
+
+// Replay
+int replay_gles_compatibility_layer_capture(const char *path, const gles_compatibility_layer_frame_callback_t callback, void *data) {
+    // Map File
+    const int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof (capture_header_t)) {
+        close(fd);
+        return -1;
+    }
+    const size_t size = info.st_size;
+    const unsigned char *file = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED) {
+        return -1;
+    }
+    madvise((void *) file, size, MADV_SEQUENTIAL);
+
+    // Check Header
+    capture_header_t header;
+    memcpy(&header, file, sizeof (header));
+    if (memcmp(header.magic, CAPTURE_MAGIC, sizeof (header.magic)) != 0 || header.version != CAPTURE_VERSION) {
+        munmap((void *) file, size);
+        return -1;
+    }
+
+    // Run Records (A Truncated Final Record Is Ignored)
+    replay_t replay = {0};
+    int frames = 0;
+    size_t position = sizeof (header);
+    while (position + sizeof (capture_record_t) <= size) {
+        capture_record_t record;
+        memcpy(&record, file + position, sizeof (record));
+        position += sizeof (record);
+        if (record.size > size - position) {
+            break;
+        }
+        reader_t reader = {
+            .data = file + position,
+            .end = file + position + record.size
+        };
+        switch (record.type) {
+            case CAPTURE_PAYLOAD: {
+                if (replay.payloads_size == replay.payloads_capacity) {
+                    replay.payloads_capacity = replay.payloads_capacity > 0 ? replay.payloads_capacity * 2 : 1024;
+                    replay.payloads = realloc(replay.payloads, replay.payloads_capacity * sizeof (const unsigned char *));
+                    ALLOC_CHECK(replay.payloads);
+                }
+                replay.payloads[replay.payloads_size++] = reader.data;
+                break;
+            }
+            case CAPTURE_FRAME: {
+                frames++;
+                if (callback != NULL) {
+                    callback(data);
+                }
+                break;
+            }
+            default: {
+                replay_record(&replay, record.type, &reader);
+                break;
+            }
+        }
+        position += CAPTURE_ALIGN(record.size);
+    }
+
+    // Free
+    free(replay.payloads);
+    free(replay.textures.names);
+    free(replay.buffers.names);
+    free(replay.lists.names);
+    free(replay.scratch);
+    munmap((void *) file, size);
+    return frames;
+}
@@ -1,16 +1,19 @@
+#include <stdlib.h>
 #include <string.h>
 
 #include "log.h"
 
-#include "state.h"
+#include "context.h"
 #include "passthrough.h"
+#include "draw.h"
+#include "list.h"
 
 // GL State
 #define init_array_pointer \
     { \
         .enabled = 0 \
     }
-static gl_state_t init_gl_state = {
+static const gl_state_t init_gl_state = {
     .color = {
         .red = 1,
         .green = 1,
@@ -22,14 +25,13 @@ static gl_state_t init_gl_state = {
         .color = init_array_pointer,
         .tex_coord = init_array_pointer
     },
-    .matrix_stacks = {
-        .mode = GL_MODELVIEW
-    },
     .alpha_test = 0,
     .texture_2d = 0,
     .fog = {
         .enabled = 0,
-        .mode = GL_LINEAR,
+        .mode = GL_LINEAR
+    },
+    .fog_parameters = {
         .color = {
             .red = 0,
             .green = 0,
@@ -38,29 +40,66 @@ static gl_state_t init_gl_state = {
         },
         .start = 0,
         .end = 1
+    },
+    .unpack_alignment = 4,
+    .server = {
+        .known = 0,
+        .caps_known = 0
+    },
+    .generation = {
+        .color = 1,
+        .fog = 1
     }
 };
-gl_state_t gl_state;
 void _init_gles_compatibility_layer_state() {
+    // Matrix Stack Storage Is Reused
+    const matrix_stacks_t matrix_stacks = gl_state.matrix_stacks;
     gl_state = init_gl_state;
+    gl_state.matrix_stacks = matrix_stacks;
+    gl_state.matrix_stacks.mode = GL_MODELVIEW;
     _init_gles_compatibility_matrix_stacks();
 }
+void _free_gles_compatibility_layer_state() {
+    free(gl_state.matrix_stacks.model_view.slots);
+    free(gl_state.matrix_stacks.projection.slots);
+    free(gl_state.matrix_stacks.texture.slots);
+}
 
 // Change Color
 void glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glColor4f, (red, green, blue, alpha));
+    if (COMPILING_LIST()) {
+        list_color(red, green, blue, alpha);
+        return;
+    }
+    if (gl_state.color.red == red && gl_state.color.green == green && gl_state.color.blue == blue && gl_state.color.alpha == alpha) {
+        return;
+    }
+    // Immediate Mode Batches Store Colors Per-Vertex
+    if (pending_draws_size > 0) {
+        flush_pending_draws();
+    }
     gl_state.color.red = red;
     gl_state.color.green = green;
     gl_state.color.blue = blue;
     gl_state.color.alpha = alpha;
+    gl_state.generation.color++;
 }
 
 // Array Pointer Storage
 #define ARRAY_POINTER_FUNC(func, name) \
     void func(GLint size, GLenum type, GLsizei stride, const void *pointer) { \
+        INSTRUMENT_ENTRY_POINT(); \
+        CAPTURE(func, (size, type, stride, pointer)); \
+        FLUSH_DRAWS(); \
         gl_state.array_pointers.name.size = size; \
         gl_state.array_pointers.name.type = type; \
         gl_state.array_pointers.name.stride = stride; \
         gl_state.array_pointers.name.pointer = pointer; \
+        GLint buffer; \
+        glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &buffer); \
+        gl_state.array_pointers.name.buffer = buffer; \
     }
 ARRAY_POINTER_FUNC(glVertexPointer, vertex)
 ARRAY_POINTER_FUNC(glColorPointer, color)
@@ -81,23 +120,77 @@ static array_pointer_t *get_array_pointer(GLenum array) {
         }
     }
 }
+#define SET_STATE(field, value) \
+    { \
+        if ((field) != (value)) { \
+            FLUSH_DRAWS(); \
+            (field) = (value); \
+        } \
+    }
 void glEnableClientState(GLenum array) {
-    get_array_pointer(array)->enabled = 1;
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glEnableClientState, (array));
+    SET_STATE(get_array_pointer(array)->enabled, 1);
 }
 void glDisableClientState(GLenum array) {
-    get_array_pointer(array)->enabled = 0;
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glDisableClientState, (array));
+    SET_STATE(get_array_pointer(array)->enabled, 0);
+}
+
+// Server Capabilities
+unsigned int get_server_cap(GLenum cap) {
+    switch (cap) {
+        case GL_BLEND: {
+            return 1 << 0;
+        }
+        case GL_DEPTH_TEST: {
+            return 1 << 1;
+        }
+        case GL_CULL_FACE: {
+            return 1 << 2;
+        }
+        case GL_SCISSOR_TEST: {
+            return 1 << 3;
+        }
+        case GL_POLYGON_OFFSET_FILL: {
+            return 1 << 4;
+        }
+        default: {
+            return 0;
+        }
+    }
+}
+static int set_server_cap(GLenum cap, GLboolean enabled) {
+    // Returns Whether The Real GL Needs To Be Called
+    unsigned int bit = get_server_cap(cap);
+    if (bit == 0) {
+        return 1;
+    }
+    if ((gl_state.server.caps_known & bit) && !!(gl_state.server.caps_enabled & bit) == !!enabled) {
+        return 0;
+    }
+    gl_state.server.caps_known |= bit;
+    if (enabled) {
+        gl_state.server.caps_enabled |= bit;
+    } else {
+        gl_state.server.caps_enabled &= ~bit;
+    }
+    return 1;
 }
 
 // Enable/Disable State
-GL_FUNC(glEnable, void, (GLenum cap));
+GL_FUNC(glEnable, void, ((GLenum, cap)));
 void glEnable(GLenum cap) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glEnable, (cap));
     switch (cap) {
         case GL_ALPHA_TEST: {
-            gl_state.alpha_test = 1;
+            SET_STATE(gl_state.alpha_test, 1);
             break;
         }
         case GL_TEXTURE_2D: {
-            gl_state.texture_2d = 1;
+            SET_STATE(gl_state.texture_2d, 1);
             break;
         }
         case GL_COLOR_MATERIAL: {
@@ -105,24 +198,29 @@ void glEnable(GLenum cap) {
             break;
         }
         case GL_FOG: {
-            gl_state.fog.enabled = 1;
+            SET_STATE(gl_state.fog.enabled, 1);
             break;
         }
         default: {
-            real_glEnable()(cap);
+            if (set_server_cap(cap, 1)) {
+                FLUSH_DRAWS();
+                real_glEnable()(cap);
+            }
             break;
         }
     }
 }
-GL_FUNC(glDisable, void, (GLenum cap));
+GL_FUNC(glDisable, void, ((GLenum, cap)));
 void glDisable(GLenum cap) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glDisable, (cap));
     switch (cap) {
         case GL_ALPHA_TEST: {
-            gl_state.alpha_test = 0;
+            SET_STATE(gl_state.alpha_test, 0);
             break;
         }
         case GL_TEXTURE_2D: {
-            gl_state.texture_2d = 0;
+            SET_STATE(gl_state.texture_2d, 0);
             break;
         }
         case GL_COLOR_MATERIAL: {
@@ -130,16 +228,21 @@ void glDisable(GLenum cap) {
             break;
         }
         case GL_FOG: {
-            gl_state.fog.enabled = 0;
+            SET_STATE(gl_state.fog.enabled, 0);
             break;
         }
         default: {
-            real_glDisable()(cap);
+            if (set_server_cap(cap, 0)) {
+                FLUSH_DRAWS();
+                real_glDisable()(cap);
+            }
             break;
         }
     }
 }
 void glAlphaFunc(GLenum func, GLclampf ref) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glAlphaFunc, (func, ref));
     if (func != GL_GREATER && ref != 0.1f) {
         ERR("Unsupported Alpha Function");
     }
@@ -148,31 +251,44 @@ void glAlphaFunc(GLenum func, GLclampf ref) {
 // Fog
 #define UNSUPPORTED_FOG() ERR("Unsupported Fog Configuration")
 void glFogfv(GLenum pname, const GLfloat *params) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glFogfv, (pname, params));
+    FLUSH_DRAWS();
     if (pname == GL_FOG_COLOR) {
-        gl_state.fog.color.red = params[0];
-        gl_state.fog.color.green = params[1];
-        gl_state.fog.color.blue = params[2];
-        gl_state.fog.color.alpha = params[3];
+        gl_state.fog_parameters.color.red = params[0];
+        gl_state.fog_parameters.color.green = params[1];
+        gl_state.fog_parameters.color.blue = params[2];
+        gl_state.fog_parameters.color.alpha = params[3];
+        gl_state.generation.fog++;
     } else {
         UNSUPPORTED_FOG();
     }
 }
 void glFogx(GLenum pname, GLfixed param) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glFogx, (pname, param));
+    FLUSH_DRAWS();
     if (pname == GL_FOG_MODE && (param == GL_LINEAR || param == GL_EXP)) {
         gl_state.fog.mode = param;
+        gl_state.generation.fog++;
     } else {
         UNSUPPORTED_FOG();
     }
 }
 void glFogf(GLenum pname, GLfloat param) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glFogf, (pname, param));
+    FLUSH_DRAWS();
     switch (pname) {
         case GL_FOG_DENSITY:
         case GL_FOG_START: {
-            gl_state.fog.start = param;
+            gl_state.fog_parameters.start = param;
+            gl_state.generation.fog++;
             break;
         }
         case GL_FOG_END: {
-            gl_state.fog.end = param;
+            gl_state.fog_parameters.end = param;
+            gl_state.generation.fog++;
             break;
         }
         default: {
@@ -183,18 +299,21 @@ void glFogf(GLenum pname, GLfloat param) {
 }
 
 // Get Matrix Data
-GL_FUNC(glGetFloatv, void, (GLenum pname, GLfloat *params));
+GL_FUNC_SYNC(glGetFloatv, void, ((GLenum, pname), (GLfloat *, params)));
 void glGetFloatv(GLenum pname, GLfloat *params) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glGetFloatv, (pname));
     switch (pname) {
         case GL_MODELVIEW_MATRIX: {
-            memcpy((void *) params, gl_state.matrix_stacks.model_view.stack[gl_state.matrix_stacks.model_view.i].data, MATRIX_DATA_SIZE);
+            memcpy((void *) params, MATRIX_STACK_TOP(&gl_state.matrix_stacks.model_view)->matrix.data, MATRIX_DATA_SIZE);
             break;
         }
         case GL_PROJECTION_MATRIX: {
-            memcpy((void *) params, gl_state.matrix_stacks.projection.stack[gl_state.matrix_stacks.projection.i].data, MATRIX_DATA_SIZE);
+            memcpy((void *) params, MATRIX_STACK_TOP(&gl_state.matrix_stacks.projection)->matrix.data, MATRIX_DATA_SIZE);
             break;
         }
         default: {
+            FLUSH_DRAWS();
             real_glGetFloatv()(pname, params);
             break;
         }
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <GLES/gl.h>
 
 #include "matrix.h"
@@ -5,9 +7,28 @@
 // Matrix Data
 #define MATRIX_STACK_DEPTH 256
 typedef struct {
-    matrix_t stack[MATRIX_STACK_DEPTH];
-    unsigned int i;
+    matrix_t matrix;
+    int type;
+    // Pushes That Have Not Been Copied Yet (Copy-On-Write)
+    unsigned int pending_pushes;
+} matrix_slot_t;
+typedef struct {
+    // Grown On Demand, Only Modified Levels Are Stored
+    matrix_slot_t *slots;
+    unsigned int size;
+    unsigned int capacity;
+    // Logical Depth (Including Pending Pushes)
+    unsigned int depth;
+    // Incremented Whenever The Top Of The Stack Changes
+    unsigned int generation;
 } matrix_stack_t;
+#define MATRIX_STACK_TOP(stack) (&(stack)->slots[(stack)->size - 1])
+typedef struct {
+    GLenum mode;
+    matrix_stack_t model_view;
+    matrix_stack_t projection;
+    matrix_stack_t texture;
+} matrix_stacks_t;
 
 // Position
 typedef struct {
@@ -31,17 +52,54 @@ typedef struct {
     GLenum type;
     GLsizei stride;
     const void *pointer;
+    // Buffer Bound When The Pointer Was Set (0 For Client-Side Arrays)
+    GLuint buffer;
 } array_pointer_t;
 
-// GL State
+// Rectangle
 typedef struct {
-    color_t color;
+    GLint x;
+    GLint y;
+    GLsizei width;
+    GLsizei height;
+} rectangle_t;
+
+// Server State Shadow
+// Bits In known Are Only Set Once The Layer Has Set That State Itself
+#define SERVER_STATE_TEXTURE_2D (1 << 0)
+#define SERVER_STATE_ARRAY_BUFFER (1 << 1)
+#define SERVER_STATE_BLEND_FUNC (1 << 2)
+#define SERVER_STATE_DEPTH_FUNC (1 << 3)
+#define SERVER_STATE_DEPTH_MASK (1 << 4)
+#define SERVER_STATE_COLOR_MASK (1 << 5)
+#define SERVER_STATE_CULL_FACE (1 << 6)
+#define SERVER_STATE_VIEWPORT (1 << 7)
+#define SERVER_STATE_SCISSOR (1 << 8)
+#define SERVER_STATE_ELEMENT_ARRAY_BUFFER (1 << 9)
+typedef struct {
+    unsigned int known;
+    GLuint texture_2d;
+    GLuint array_buffer;
+    GLuint element_array_buffer;
     struct {
-        GLenum mode;
-        matrix_stack_t model_view;
-        matrix_stack_t projection;
-        matrix_stack_t texture;
-    } matrix_stacks;
+        GLenum sfactor;
+        GLenum dfactor;
+    } blend_func;
+    GLenum depth_func;
+    GLboolean depth_mask;
+    GLboolean color_mask[4];
+    GLenum cull_face;
+    rectangle_t viewport;
+    rectangle_t scissor;
+    // Capabilities Passed Through By glEnable/glDisable
+    unsigned int caps_known;
+    unsigned int caps_enabled;
+} server_state_t;
+
+// GL State
+// Fields Read By Every Draw Come First So They Share As Few Cache Lines As Possible
+typedef struct {
+    // Hot
     struct {
         array_pointer_t vertex;
         array_pointer_t color;
@@ -52,11 +110,25 @@ typedef struct {
     struct {
         GLboolean enabled;
         GLfixed mode;
+    } fog;
+    // Dirty Tracking (Incremented On Every Change)
+    struct {
+        unsigned int color;
+        unsigned int fog;
+    } generation;
+    matrix_stacks_t matrix_stacks;
+    // Cold (Only Read When The Matching Generation Changes)
+    color_t color;
+    struct {
         color_t color;
         GLfloat start;
         GLfloat end;
-    } fog;
-} gl_state_t;
-extern gl_state_t gl_state;
+    } fog_parameters;
+    server_state_t server;
+    GLint unpack_alignment;
+} __attribute__((aligned(64))) gl_state_t;
+// The Current Context's State Is Accessed As gl_state (See context.h)
 void _init_gles_compatibility_layer_state();
+void _free_gles_compatibility_layer_state();
+unsigned int get_server_cap(GLenum cap);
 void _init_gles_compatibility_matrix_stacks();
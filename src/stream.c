@@ -0,0 +1,37 @@
+#include "stream.h"
+#include "context.h"
+#include "log.h"
+
+// Constants
+#define REAL_GL_STREAM_DRAW 0x88e0
+#define STREAM_BUFFER_SIZE (4 * 1024 * 1024)
+
+// Ring Buffer (Per Context)
+GLintptr stream_reserve(const GLsizeiptr size) {
+    stream_context_t *stream = &current_context->stream;
+
+    // Create Buffer
+    if (stream->buffer == 0) {
+        glGenBuffers(1, &stream->buffer);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+
+    // Align
+    GLintptr offset = STREAM_ALIGN(stream->offset);
+
+    // Orphan When Full (Instead Of Waiting For Pending Draws)
+    if (offset + size > stream->size) {
+        if (size > stream->size) {
+            stream->size = size > STREAM_BUFFER_SIZE ? size : STREAM_BUFFER_SIZE;
+        }
+        glBufferData(GL_ARRAY_BUFFER, stream->size, NULL, REAL_GL_STREAM_DRAW);
+        offset = 0;
+    }
+
+    // Return
+    stream->offset = offset + size;
+    return offset;
+}
+GLuint get_stream_buffer() {
+    return current_context->stream.buffer;
+}
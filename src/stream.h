@@ -0,0 +1,16 @@
+#pragma once
+
+#include <GLES/gl.h>
+
+// Streaming Vertex Buffer
+// Client-Side Data Is Copied Into A Large Buffer That Is Orphaned When Full
+#define STREAM_ALIGNMENT 16
+#define STREAM_ALIGN(size) (((size) + (STREAM_ALIGNMENT - 1)) & ~((GLintptr) STREAM_ALIGNMENT - 1))
+typedef struct {
+    GLuint buffer;
+    GLsizeiptr size;
+    GLintptr offset;
+} stream_context_t;
+// Binds The Streaming Buffer And Reserves Space In It, Returning The Offset
+GLintptr stream_reserve(GLsizeiptr size);
+GLuint get_stream_buffer();
@@ -0,0 +1,333 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "texture.h"
+#include "passthrough.h"
+#include "context.h"
+#include "draw.h"
+#include "log.h"
+
+// Formats Missing From The Public Header
+#define REAL_GL_LUMINANCE 0x1909
+#define REAL_GL_LUMINANCE_ALPHA 0x190a
+
+// Size Of Client-Side Image Data (Used When Queueing Or Capturing Uploads)
+// Returns 0 For Unknown Formats, Which Are Passed Through Without Staging
+static size_t get_pixel_size(GLenum format, GLenum type) {
+    switch (type) {
+        case GL_UNSIGNED_BYTE: {
+            switch (format) {
+                case GL_RGBA: {
+                    return 4;
+                }
+                case GL_RGB: {
+                    return 3;
+                }
+                case REAL_GL_LUMINANCE_ALPHA: {
+                    return 2;
+                }
+                case GL_ALPHA:
+                case REAL_GL_LUMINANCE: {
+                    return 1;
+                }
+                default: {
+                    return 0;
+                }
+            }
+        }
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+        case GL_UNSIGNED_SHORT_5_6_5: {
+            return 2;
+        }
+        default: {
+            return 0;
+        }
+    }
+}
+static size_t get_row_size(GLsizei width, size_t pixel_size) {
+    const size_t alignment = gl_state.unpack_alignment;
+    return ((width * pixel_size) + (alignment - 1)) / alignment * alignment;
+}
+size_t get_image_size(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+    const size_t pixel_size = get_pixel_size(format, type);
+    if (pixel_size == 0) {
+        return UNKNOWN_IMAGE_SIZE;
+    }
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    return (get_row_size(width, pixel_size) * (height - 1)) + (width * pixel_size);
+}
+// Unknown Sizes Cannot Be Copied, So Those Calls Wait For The Driver To Read The Pixels Instead
+static size_t get_queued_image_size(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+    const size_t size = get_image_size(width, height, format, type);
+    return size == UNKNOWN_IMAGE_SIZE ? MAX_QUEUED_PAYLOAD_SIZE + 1 : size;
+}
+
+// Functions
+GL_FUNC_COPY(glTexImage2D, void, ((GLenum, target), (GLint, level), (GLint, internalformat), (GLsizei, width), (GLsizei, height), (GLint, border), (GLenum, format), (GLenum, type), (const void *, pixels)), ((pixels, get_queued_image_size(width, height, format, type))));
+GL_FUNC_COPY(glTexSubImage2D, void, ((GLenum, target), (GLint, level), (GLint, xoffset), (GLint, yoffset), (GLsizei, width), (GLsizei, height), (GLenum, format), (GLenum, type), (const void *, pixels)), ((pixels, get_queued_image_size(width, height, format, type))));
+GL_FUNC_COPY(glDeleteTextures, void, ((GLsizei, n), (const GLuint *, textures)), ((textures, n * sizeof (GLuint))));
+
+// Statistics (Per Context)
+#define stats (current_context->textures.stats)
+void get_gles_compatibility_layer_texture_stats(gles_compatibility_layer_texture_stats_t *out) {
+    *out = stats;
+}
+void reset_gles_compatibility_layer_texture_stats() {
+    memset(&stats, 0, sizeof (stats));
+}
+
+// Tracked Textures (Per Share Group, Guarded By Its Lock)
+#define tracked_textures (current_context->share_group->textures.tracked)
+#define tracked_textures_size (current_context->share_group->textures.size)
+#define pending_texture_uploads (current_context->share_group->textures.pending_uploads)
+#define packed_rows (current_context->textures.packed)
+#define packed_rows_size (current_context->textures.packed_size)
+static void free_texture(texture_t *texture) {
+    free(texture->staging);
+    free(texture->dirty);
+    memset(texture, 0, sizeof (texture_t));
+}
+void _free_gles_compatibility_layer_tracked_textures(tracked_textures_t *textures) {
+    for (GLuint i = 0; i < textures->size; i++) {
+        free_texture(&textures->tracked[i]);
+    }
+    free(textures->tracked);
+    textures->tracked = NULL;
+    textures->size = 0;
+    textures->pending_uploads = 0;
+}
+void _free_gles_compatibility_layer_textures() {
+    free(packed_rows);
+}
+static texture_t *get_texture(const GLuint name, const int create) {
+    if (name >= tracked_textures_size) {
+        if (!create) {
+            return NULL;
+        }
+        const GLuint new_size = name + 1;
+        tracked_textures = realloc(tracked_textures, new_size * sizeof (texture_t));
+        ALLOC_CHECK(tracked_textures);
+        memset(&tracked_textures[tracked_textures_size], 0, (new_size - tracked_textures_size) * sizeof (texture_t));
+        tracked_textures_size = new_size;
+    }
+    return &tracked_textures[name];
+}
+static GLuint get_bound_texture() {
+    GLint texture;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+    return texture;
+}
+static void discard_updates(texture_t *texture) {
+    if (texture->dirty_size > 0) {
+        texture->dirty_size = 0;
+        texture->staged_bytes = 0;
+        __atomic_sub_fetch(&pending_texture_uploads, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Merge Rectangles When Their Union Is Exactly Covered
+// Anything Else Would Upload Texels That Are Not Current In The Staging Copy
+static int contains(const rectangle_t *a, const rectangle_t *b) {
+    return b->x >= a->x && b->y >= a->y && b->x + b->width <= a->x + a->width && b->y + b->height <= a->y + a->height;
+}
+static int try_merge(rectangle_t *a, const rectangle_t *b) {
+    if (contains(a, b)) {
+        return 1;
+    }
+    if (contains(b, a)) {
+        *a = *b;
+        return 1;
+    }
+    // Same Columns, Overlapping Or Adjacent Rows
+    if (a->x == b->x && a->width == b->width && b->y <= a->y + a->height && a->y <= b->y + b->height) {
+        const GLint end = a->y + a->height > b->y + b->height ? a->y + a->height : b->y + b->height;
+        a->y = a->y < b->y ? a->y : b->y;
+        a->height = end - a->y;
+        return 1;
+    }
+    // Same Rows, Overlapping Or Adjacent Columns
+    if (a->y == b->y && a->height == b->height && b->x <= a->x + a->width && a->x <= b->x + b->width) {
+        const GLint end = a->x + a->width > b->x + b->width ? a->x + a->width : b->x + b->width;
+        a->x = a->x < b->x ? a->x : b->x;
+        a->width = end - a->x;
+        return 1;
+    }
+    return 0;
+}
+static void add_dirty(texture_t *texture, rectangle_t rectangle) {
+    // Merge Until Nothing Changes
+    for (int i = 0; i < texture->dirty_size; i++) {
+        if (try_merge(&rectangle, &texture->dirty[i])) {
+            texture->dirty[i] = texture->dirty[--texture->dirty_size];
+            i = -1;
+        }
+    }
+    if (texture->dirty_size >= texture->dirty_capacity) {
+        texture->dirty_capacity = texture->dirty_capacity > 0 ? texture->dirty_capacity * 2 : 16;
+        texture->dirty = realloc(texture->dirty, texture->dirty_capacity * sizeof (rectangle_t));
+        ALLOC_CHECK(texture->dirty);
+    }
+    texture->dirty[texture->dirty_size++] = rectangle;
+}
+
+// Stage An Update
+static int stage_update(GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels) {
+    // Check
+    texture_t *texture = get_texture(get_bound_texture(), 0);
+    if (texture == NULL || !texture->defined || format != texture->format || type != texture->type || pixels == NULL) {
+        return 0;
+    }
+    if (width <= 0 || height <= 0 || xoffset < 0 || yoffset < 0 || xoffset + width > texture->width || yoffset + height > texture->height) {
+        // Let The Driver Report Errors
+        return 0;
+    }
+
+    // Copy Into Staging Area
+    const size_t pixel_size = texture->pixel_size;
+    if (texture->staging == NULL) {
+        texture->staging = malloc(texture->width * texture->height * pixel_size);
+        ALLOC_CHECK(texture->staging);
+    }
+    const size_t src_row_size = get_row_size(width, pixel_size);
+    const size_t dst_row_size = texture->width * pixel_size;
+    unsigned char *dst = texture->staging + (yoffset * dst_row_size) + (xoffset * pixel_size);
+    const unsigned char *src = pixels;
+    for (GLsizei y = 0; y < height; y++) {
+        memcpy(dst, src, width * pixel_size);
+        dst += dst_row_size;
+        src += src_row_size;
+    }
+
+    // Mark Dirty
+    if (texture->dirty_size == 0) {
+        __atomic_add_fetch(&pending_texture_uploads, 1, __ATOMIC_RELAXED);
+    }
+    const rectangle_t rectangle = {xoffset, yoffset, width, height};
+    add_dirty(texture, rectangle);
+    const size_t size = width * height * pixel_size;
+    texture->staged_bytes += size;
+    stats.staged_calls++;
+    stats.bytes_staged += size;
+    return 1;
+}
+
+// Upload Staged Data (Texture Must Be Bound)
+static void upload(texture_t *texture) {
+    const size_t pixel_size = texture->pixel_size;
+    const size_t staging_row_size = texture->width * pixel_size;
+    size_t uploaded_bytes = 0;
+    for (int i = 0; i < texture->dirty_size; i++) {
+        const rectangle_t *rectangle = &texture->dirty[i];
+        const unsigned char *src = texture->staging + (rectangle->y * staging_row_size) + (rectangle->x * pixel_size);
+        const size_t row_size = get_row_size(rectangle->width, pixel_size);
+        const void *pixels = src;
+        if (rectangle->width != texture->width || row_size != staging_row_size) {
+            // ES2 Has No GL_UNPACK_ROW_LENGTH, So Rows Are Packed First
+            const size_t size = row_size * rectangle->height;
+            if (packed_rows_size < size) {
+                packed_rows_size = size;
+                packed_rows = realloc(packed_rows, packed_rows_size);
+                ALLOC_CHECK(packed_rows);
+            }
+            for (GLsizei y = 0; y < rectangle->height; y++) {
+                memcpy(packed_rows + (y * row_size), src + (y * staging_row_size), rectangle->width * pixel_size);
+            }
+            pixels = packed_rows;
+        }
+        real_glTexSubImage2D()(GL_TEXTURE_2D, 0, rectangle->x, rectangle->y, rectangle->width, rectangle->height, texture->format, texture->type, pixels);
+        uploaded_bytes += rectangle->width * rectangle->height * pixel_size;
+    }
+    stats.uploads += texture->dirty_size;
+    stats.bytes_uploaded += uploaded_bytes;
+    stats.bytes_saved += texture->staged_bytes - uploaded_bytes;
+    discard_updates(texture);
+    // Nothing Is Dirty, So The Copy Is Not Needed Until The Next Update
+    free(texture->staging);
+    texture->staging = NULL;
+}
+void flush_texture_uploads() {
+    lock_share_group();
+    texture_t *texture = get_texture(get_bound_texture(), 0);
+    if (texture != NULL && texture->dirty_size > 0) {
+        upload(texture);
+    }
+    unlock_share_group();
+}
+void flush_all_texture_uploads() {
+    lock_share_group();
+    if (pending_texture_uploads > 0) {
+        const GLuint current_texture = get_bound_texture();
+        for (GLuint i = 0; i < tracked_textures_size && pending_texture_uploads > 0; i++) {
+            if (tracked_textures[i].dirty_size > 0) {
+                glBindTexture(GL_TEXTURE_2D, i);
+                upload(&tracked_textures[i]);
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, current_texture);
+    }
+    unlock_share_group();
+}
+
+// Texture Functions
+void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glTexImage2D, (target, level, internalformat, width, height, border, format, type, pixels));
+    FLUSH_DRAWS();
+    if (target == GL_TEXTURE_2D && level == 0) {
+        // Redefining The Texture Replaces Any Staged Updates
+        lock_share_group();
+        texture_t *texture = get_texture(get_bound_texture(), 1);
+        discard_updates(texture);
+        const size_t pixel_size = get_pixel_size(format, type);
+        if (texture->width != width || texture->height != height || texture->pixel_size != pixel_size) {
+            free(texture->staging);
+            texture->staging = NULL;
+        }
+        // Unknown Formats Are Never Staged
+        texture->defined = width > 0 && height > 0 && pixel_size > 0;
+        texture->width = width;
+        texture->height = height;
+        texture->format = format;
+        texture->type = type;
+        texture->pixel_size = pixel_size;
+        unlock_share_group();
+    }
+    real_glTexImage2D()(target, level, internalformat, width, height, border, format, type, pixels);
+}
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glTexSubImage2D, (target, level, xoffset, yoffset, width, height, format, type, pixels));
+    // Pending Draws Must See The Old Contents
+    FLUSH_DRAWS();
+    lock_share_group();
+    if (target == GL_TEXTURE_2D && level == 0 && stage_update(xoffset, yoffset, width, height, format, type, pixels)) {
+        unlock_share_group();
+        return;
+    }
+    // Staged Updates Come First
+    FLUSH_TEXTURE_UPLOADS();
+    real_glTexSubImage2D()(target, level, xoffset, yoffset, width, height, format, type, pixels);
+    unlock_share_group();
+}
+void glDeleteTextures(GLsizei n, const GLuint *textures) {
+    INSTRUMENT_ENTRY_POINT();
+    CAPTURE(glDeleteTextures, (n, textures));
+    FLUSH_DRAWS();
+    // Deleting A Bound Texture Unbinds It
+    lock_share_group();
+    for (GLsizei i = 0; i < n; i++) {
+        if (textures[i] != 0 && textures[i] == gl_state.server.texture_2d) {
+            gl_state.server.texture_2d = 0;
+        }
+        texture_t *texture = get_texture(textures[i], 0);
+        if (texture != NULL) {
+            discard_updates(texture);
+            free_texture(texture);
+        }
+    }
+    unlock_share_group();
+    real_glDeleteTextures()(n, textures);
+}
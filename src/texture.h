@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <GLES/gl.h>
+
+#include "state.h"
+
+// Texture Upload Scheduler
+// glTexSubImage2D Calls Are Staged On The CPU And Merged, Then Uploaded Right Before The Texture Is Drawn With
+// Texture Names Are Shared, So Updates Are Tracked Per Share Group And Uploaded By Whichever Context Draws With The Texture First (At The Latest On glFlush)
+typedef struct {
+    // Level 0 Was Defined Through The Layer
+    GLboolean defined;
+    GLsizei width;
+    GLsizei height;
+    GLenum format;
+    GLenum type;
+    size_t pixel_size;
+    // Tightly Packed Copy Of Level 0 (Allocated On The First Update And Freed Once Uploaded, Only Dirty Areas Are Current)
+    unsigned char *staging;
+    // Dirty Rectangles (Each Texel In Them Was Written Since The Last Upload)
+    rectangle_t *dirty;
+    int dirty_size;
+    int dirty_capacity;
+    // Bytes Passed To glTexSubImage2D Since The Last Upload
+    size_t staged_bytes;
+} texture_t;
+typedef struct {
+    // Indexed By Texture Name
+    texture_t *tracked;
+    GLuint size;
+    // Textures With Staged Updates (Read Without The Lock By Draws)
+    GLsizei pending_uploads;
+} tracked_textures_t;
+void _free_gles_compatibility_layer_tracked_textures(tracked_textures_t *textures);
+typedef struct {
+    // Scratch Space For Packing Rows Before An Upload
+    unsigned char *packed;
+    size_t packed_size;
+    gles_compatibility_layer_texture_stats_t stats;
+} texture_context_t;
+void _free_gles_compatibility_layer_textures();
+// Bytes Read From Client Memory By glTexImage2D/glTexSubImage2D (Using The Current Unpack Alignment)
+// Returns UNKNOWN_IMAGE_SIZE For Formats The Layer Does Not Know
+#define UNKNOWN_IMAGE_SIZE SIZE_MAX
+size_t get_image_size(GLsizei width, GLsizei height, GLenum format, GLenum type);
+// Uploads The Staged Updates Of The Bound Texture
+void flush_texture_uploads();
+// Uploads The Staged Updates Of Every Texture
+void flush_all_texture_uploads();
+#define FLUSH_TEXTURE_UPLOADS() \
+    { \
+        if (__atomic_load_n(&current_context->share_group->textures.pending_uploads, __ATOMIC_RELAXED) > 0) { \
+            flush_texture_uploads(); \
+        } \
+    }
@@ -0,0 +1,187 @@
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include <GLES/gl.h>
+
+#include "thread.h"
+#include "context.h"
+#include "log.h"
+
+// State
+gles_compatibility_layer_context_t *gl_thread_context = NULL;
+__thread int is_gl_thread = 0;
+
+// Ring Buffer
+// Single Producer (The Application Thread), Single Consumer (The Submission Thread)
+#define RING_SIZE (8 * 1024 * 1024)
+typedef struct {
+    queued_call_t run;
+    size_t size;
+} record_header_t;
+#define HEADER_SIZE QUEUED_ALIGN(sizeof (record_header_t))
+static unsigned char *ring = NULL;
+static _Atomic size_t head;
+static _Atomic size_t tail;
+static size_t pending_head;
+
+// Sleeping
+static sem_t consumer_wake;
+static atomic_int consumer_sleeping;
+static sem_t producer_wake;
+static atomic_int producer_waiting;
+
+// Producer
+void *begin_queued_call(const queued_call_t run, const size_t size) {
+    const size_t record_size = HEADER_SIZE + QUEUED_ALIGN(size);
+    if (record_size > RING_SIZE / 2) {
+        ERR("Queued Call Too Large: %zu", size);
+    }
+    size_t position = atomic_load_explicit(&head, memory_order_relaxed);
+
+    // Records Never Wrap Around The End
+    size_t needed = record_size;
+    const size_t space_before_end = RING_SIZE - (position % RING_SIZE);
+    if (space_before_end < record_size) {
+        needed += space_before_end;
+    }
+
+    // Wait For Space
+    while ((position + needed) - atomic_load_explicit(&tail, memory_order_acquire) > RING_SIZE) {
+        sched_yield();
+    }
+
+    // Padding
+    if (needed != record_size) {
+        record_header_t *padding = (record_header_t *) &ring[position % RING_SIZE];
+        padding->run = NULL;
+        padding->size = space_before_end;
+        position += space_before_end;
+    }
+
+    // Header
+    record_header_t *header = (record_header_t *) &ring[position % RING_SIZE];
+    header->run = run;
+    header->size = record_size;
+    pending_head = position + record_size;
+    return ((unsigned char *) header) + HEADER_SIZE;
+}
+void end_queued_call() {
+    atomic_store_explicit(&head, pending_head, memory_order_release);
+    if (atomic_exchange(&consumer_sleeping, 0)) {
+        sem_post(&consumer_wake);
+    }
+}
+void wait_for_queued_calls() {
+    while (atomic_load_explicit(&tail, memory_order_acquire) != atomic_load_explicit(&head, memory_order_relaxed)) {
+        atomic_store(&producer_waiting, 1);
+        if (atomic_load_explicit(&tail, memory_order_acquire) == atomic_load_explicit(&head, memory_order_relaxed)) {
+            atomic_store(&producer_waiting, 0);
+            break;
+        }
+        sem_wait(&producer_wake);
+    }
+}
+
+// Consumer
+static int running;
+static void stop_thread(__attribute__((unused)) void *data) {
+    running = 0;
+}
+static pthread_t thread;
+static gles_compatibility_layer_thread_callback_t thread_callback;
+static void *thread_callback_data;
+static void *thread_main(__attribute__((unused)) void *data) {
+    is_gl_thread = 1;
+    current_context = gl_thread_context;
+    gl_dispatch = &gl_thread_context->dispatch;
+    thread_callback(thread_callback_data, 1);
+    running = 1;
+    while (running) {
+        // Wait For Work
+        size_t position = atomic_load_explicit(&tail, memory_order_relaxed);
+        if (position == atomic_load_explicit(&head, memory_order_acquire)) {
+            atomic_store(&consumer_sleeping, 1);
+            if (position == atomic_load_explicit(&head, memory_order_acquire)) {
+                sem_wait(&consumer_wake);
+            }
+            atomic_store(&consumer_sleeping, 0);
+            continue;
+        }
+
+        // Run
+        record_header_t *header = (record_header_t *) &ring[position % RING_SIZE];
+        if (header->run != NULL) {
+            header->run(((unsigned char *) header) + HEADER_SIZE);
+        }
+        atomic_store_explicit(&tail, position + header->size, memory_order_release);
+
+        // Wake Producer
+        if (atomic_load_explicit(&tail, memory_order_relaxed) == atomic_load_explicit(&head, memory_order_acquire) && atomic_exchange(&producer_waiting, 0)) {
+            sem_post(&producer_wake);
+        }
+    }
+    thread_callback(thread_callback_data, 0);
+    return NULL;
+}
+
+// Start/Stop
+void start_gles_compatibility_layer_thread(const gles_compatibility_layer_thread_callback_t callback, void *data) {
+    if (gl_thread_context != NULL) {
+        return;
+    }
+    if (ring == NULL) {
+        ring = malloc(RING_SIZE);
+        ALLOC_CHECK(ring);
+    }
+    atomic_store(&head, 0);
+    atomic_store(&tail, 0);
+    atomic_store(&consumer_sleeping, 0);
+    atomic_store(&producer_waiting, 0);
+    sem_init(&consumer_wake, 0, 0);
+    sem_init(&producer_wake, 0, 0);
+    thread_callback = callback;
+    thread_callback_data = data;
+    // The Thread Serves The Current Context
+    gl_thread_context = current_context;
+    if (pthread_create(&thread, NULL, thread_main, NULL) != 0) {
+        ERR("Unable To Start GL Thread");
+    }
+    gl_dispatch = &gl_queue_dispatch;
+}
+void stop_gles_compatibility_layer_thread() {
+    if (gl_thread_context == NULL || is_gl_thread) {
+        return;
+    }
+    FLUSH_DRAWS();
+    begin_queued_call(stop_thread, 0);
+    end_queued_call();
+    pthread_join(thread, NULL);
+    gl_dispatch = &gl_thread_context->dispatch;
+    gl_thread_context = NULL;
+    sem_destroy(&consumer_wake);
+    sem_destroy(&producer_wake);
+}
+
+// Callbacks
+typedef struct {
+    void (*func)(void *);
+    void *data;
+} queued_callback_t;
+static void run_callback(void *data) {
+    queued_callback_t *callback = data;
+    callback->func(callback->data);
+}
+void queue_gles_compatibility_layer_callback(void (*func)(void *), void *data) {
+    FLUSH_DRAWS();
+    if (SHOULD_QUEUE()) {
+        queued_callback_t *callback = begin_queued_call(run_callback, sizeof (queued_callback_t));
+        callback->func = func;
+        callback->data = data;
+        end_queued_call();
+    } else {
+        func(data);
+    }
+}
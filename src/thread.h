@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <GLES/gl.h>
+
+// Submission Thread
+// When Active, Real GL Calls Made For Its Context Outside The Submission Thread Are Encoded Into A Ring Buffer
+extern gles_compatibility_layer_context_t *gl_thread_context;
+extern __thread int is_gl_thread;
+#define SHOULD_QUEUE() (gl_dispatch == &gl_queue_dispatch)
+
+// Queued Calls
+typedef void (*queued_call_t)(void *data);
+// Reserves A Record Of The Given Size And Returns Its Data
+void *begin_queued_call(queued_call_t run, size_t size);
+// Publishes The Record Started By begin_queued_call()
+void end_queued_call();
+// Waits Until Every Published Record Has Been Executed
+void wait_for_queued_calls();
+// Payloads Larger Than This Are Not Copied, The Call Is Made Synchronous Instead
+#define MAX_QUEUED_PAYLOAD_SIZE (1024 * 1024)
+#define QUEUED_ALIGNMENT 16
+#define QUEUED_ALIGN(size) (((size) + (QUEUED_ALIGNMENT - 1)) & ~((size_t) QUEUED_ALIGNMENT - 1))
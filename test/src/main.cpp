@@ -51,6 +51,8 @@ static void load_header(std::string filename) {
 static void load_headers() {
     header_lines.clear();
     load_header("/usr/include/GLES2/gl2.h");
+    load_header("/usr/include/GLES2/gl2ext.h");
+    load_header("/usr/include/GLES3/gl3.h");
 }
 
 // Run Test
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "matrix.h"
+
+#define INFO(format, ...) \
+    { \
+        fprintf(stderr, "[INFO]: " format "\n", ##__VA_ARGS__); \
+    }
+#define ERR(format, ...) \
+    { \
+        fprintf(stderr, "[ERR]: (%s:%i): " format "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
+        exit(EXIT_FAILURE); \
+    }
+
+// The Library Is Built With Function Tests Enabled
+void add_test(__attribute__((unused)) const char *function_name) {
+}
+
+// Compare Floats In Units In The Last Place
+// Vector Code May Produce -0 Where The Scalar Code Produces +0, Or Use Fused Multiply-Add
+#define MAX_ULPS 4
+static int32_t to_ordered(const float value) {
+    int32_t bits;
+    memcpy(&bits, &value, sizeof (bits));
+    return bits < 0 ? INT32_MIN - bits : bits;
+}
+static int64_t ulps(const float a, const float b) {
+    const int64_t difference = (int64_t) to_ordered(a) - (int64_t) to_ordered(b);
+    return difference < 0 ? -difference : difference;
+}
+
+// Random Matrices
+static float random_float() {
+    return (((float) rand() / (float) RAND_MAX) * 200.f) - 100.f;
+}
+static void random_matrix(matrix_t *matrix) {
+    for (int x = 0; x < MATRIX_SIZE; x++) {
+        for (int y = 0; y < MATRIX_SIZE; y++) {
+            matrix->data[x][y] = random_float();
+        }
+    }
+}
+
+// Check One Multiplication
+static void check(const matrix_t *a, const matrix_t *b) {
+    matrix_t expected;
+    multiply_matrices_scalar(&expected, a, b);
+
+    // Separate Output
+    matrix_t out;
+    multiply_matrices(&out, a, b);
+    // Aliased Output
+    matrix_t aliased_a = *a;
+    multiply_matrices(&aliased_a, &aliased_a, b);
+    matrix_t aliased_b = *b;
+    multiply_matrices(&aliased_b, a, &aliased_b);
+
+    // Compare
+    const matrix_t *results[] = {&out, &aliased_a, &aliased_b};
+    for (unsigned int i = 0; i < sizeof (results) / sizeof (results[0]); i++) {
+        for (int x = 0; x < MATRIX_SIZE; x++) {
+            for (int y = 0; y < MATRIX_SIZE; y++) {
+                const float actual = results[i]->data[x][y];
+                const float wanted = expected.data[x][y];
+                if (ulps(actual, wanted) > MAX_ULPS) {
+                    // Cancellation Can Leave Results Near Zero With Large Relative Error
+                    float magnitude = 0;
+                    for (int j = 0; j < MATRIX_SIZE; j++) {
+                        const float term = a->data[j][y] * b->data[x][j];
+                        magnitude += term < 0 ? -term : term;
+                    }
+                    const float error = actual > wanted ? actual - wanted : wanted - actual;
+                    if (error > magnitude * 1e-6f) {
+                        ERR("Mismatch At [%i][%i] (Case %u): %.9g != %.9g", x, y, i, actual, wanted);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Random Matrix Of A Given Type
+static void random_typed_matrix(matrix_t *matrix, const int type) {
+    if (type & MATRIX_TYPE_GENERAL) {
+        random_matrix(matrix);
+        return;
+    }
+    *matrix = identity_matrix;
+    if (type & MATRIX_TYPE_AFFINE) {
+        for (int x = 0; x < 3; x++) {
+            for (int y = 0; y < 3; y++) {
+                matrix->data[x][y] = random_float();
+            }
+        }
+    } else if (type & MATRIX_TYPE_SCALE) {
+        for (int i = 0; i < 3; i++) {
+            matrix->data[i][i] = random_float();
+        }
+    }
+    if (type & MATRIX_TYPE_TRANSLATE) {
+        for (int y = 0; y < 3; y++) {
+            matrix->data[3][y] = random_float();
+        }
+    }
+}
+
+// Check Typed Multiplication
+static void check_typed() {
+    INFO("Checking Typed Matrix Multiplication...");
+    static const int types[] = {
+        MATRIX_TYPE_IDENTITY,
+        MATRIX_TYPE_TRANSLATE,
+        MATRIX_TYPE_SCALE,
+        MATRIX_TYPE_SCALE | MATRIX_TYPE_TRANSLATE,
+        MATRIX_TYPE_AFFINE,
+        MATRIX_TYPE_AFFINE | MATRIX_TYPE_TRANSLATE,
+        MATRIX_TYPE_GENERAL
+    };
+    const int types_size = sizeof (types) / sizeof (types[0]);
+    for (int i = 0; i < 10000; i++) {
+        const int a_type = types[rand() % types_size];
+        const int b_type = types[rand() % types_size];
+        matrix_t a;
+        matrix_t b;
+        random_typed_matrix(&a, a_type);
+        random_typed_matrix(&b, b_type);
+        if (get_matrix_type(&a) != a_type || get_matrix_type(&b) != b_type) {
+            ERR("Incorrect Matrix Type");
+        }
+        // Compare In Place (Like The Matrix Stack)
+        matrix_t expected;
+        multiply_matrices_scalar(&expected, &a, &b);
+        const int type = multiply_typed_matrices(&a, &a, a_type, &b, b_type);
+        if ((get_matrix_type(&expected) & ~type) != 0) {
+            ERR("Result Type Is Too Specific");
+        }
+        for (int x = 0; x < MATRIX_SIZE; x++) {
+            for (int y = 0; y < MATRIX_SIZE; y++) {
+                const float error = a.data[x][y] > expected.data[x][y] ? a.data[x][y] - expected.data[x][y] : expected.data[x][y] - a.data[x][y];
+                const float magnitude = expected.data[x][y] < 0 ? -expected.data[x][y] : expected.data[x][y];
+                if (error > (magnitude + 1) * 1e-3f) {
+                    ERR("Typed Mismatch At [%i][%i]: %.9g != %.9g", x, y, a.data[x][y], expected.data[x][y]);
+                }
+            }
+        }
+    }
+}
+
+// Main
+int main() {
+    INFO("Checking Matrix Multiplication...");
+    srand(0);
+
+    // Identity
+    matrix_t random;
+    random_matrix(&random);
+    check(&identity_matrix, &random);
+    check(&random, &identity_matrix);
+
+    // Exact Values Must Match Exactly
+    matrix_t a;
+    matrix_t b;
+    for (int x = 0; x < MATRIX_SIZE; x++) {
+        for (int y = 0; y < MATRIX_SIZE; y++) {
+            a.data[x][y] = (float) ((x * MATRIX_SIZE) + y);
+            b.data[x][y] = (float) (y - x);
+        }
+    }
+    matrix_t expected;
+    matrix_t out;
+    multiply_matrices_scalar(&expected, &a, &b);
+    multiply_matrices(&out, &a, &b);
+    if (memcmp(&expected, &out, sizeof (matrix_t)) != 0) {
+        ERR("Integer Results Differ");
+    }
+
+    // Random
+    for (int i = 0; i < 100000; i++) {
+        random_matrix(&a);
+        random_matrix(&b);
+        check(&a, &b);
+    }
+    check_typed();
+
+    // Done
+    INFO("Matrix Test Complete");
+}
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <GLES/gl.h>
+
+#define INFO(format, ...) \
+    { \
+        fprintf(stderr, "[INFO]: " format "\n", ##__VA_ARGS__); \
+    }
+#define WARN(format, ...) \
+    { \
+        fprintf(stderr, "[WARN]: " format "\n", ##__VA_ARGS__); \
+    }
+#define ERR(format, ...) \
+    { \
+        fprintf(stderr, "[ERR]: (%s:%i): " format "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
+        exit(EXIT_FAILURE); \
+    }
+
+// Time
+static uint64_t get_time() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return ((uint64_t) time.tv_sec * 1000000000ull) + time.tv_nsec;
+}
+
+// Frame Timing
+typedef struct {
+    GLFWwindow *window;
+    uint64_t frame_start;
+    // Milliseconds
+    double *frames;
+    int frames_size;
+    int frames_capacity;
+} timing_t;
+static void end_frame(void *data) {
+    timing_t *timing = data;
+    // Deferred Draws Must Be Flushed Before Swapping
+    glFlush();
+    glfwSwapBuffers(timing->window);
+    const uint64_t time = get_time();
+    if (timing->frames_size == timing->frames_capacity) {
+        timing->frames_capacity = timing->frames_capacity > 0 ? timing->frames_capacity * 2 : 256;
+        timing->frames = realloc(timing->frames, timing->frames_capacity * sizeof (double));
+        if (timing->frames == NULL) {
+            ERR("Memory Allocation Failed");
+        }
+    }
+    timing->frames[timing->frames_size++] = (double) (time - timing->frame_start) / 1000000.0;
+    timing->frame_start = time;
+}
+static int compare_frames(const void *a, const void *b) {
+    const double x = *(const double *) a;
+    const double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+// Handle GLFW Error
+static void glfw_error(__attribute__((unused)) int error, const char *description) {
+    WARN("GLFW Error: %s", description);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        ERR("Usage: %s <capture>", argv[0]);
+    }
+
+    // Init GLFW
+    glfwSetErrorCallback(glfw_error);
+    if (!glfwInit()) {
+        ERR("Unable To Initialize GLFW");
+    }
+
+    // Create OpenGL ES Context
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    // Create Window
+    GLFWwindow *glfw_window = glfwCreateWindow(640, 480, "Replay", NULL, NULL);
+    if (!glfw_window) {
+        ERR("Unable To Create GLFW Window");
+    }
+
+    // Make Window Context Current (Without VSync)
+    glfwMakeContextCurrent(glfw_window);
+    glfwSwapInterval(0);
+
+    // Setup Compatibility Layer
+    init_gles_compatibility_layer((getProcAddress_t) glfwGetProcAddress);
+
+    // Replay
+    INFO("Replaying %s...", argv[1]);
+    timing_t timing = {
+        .window = glfw_window
+    };
+    const uint64_t start = get_time();
+    timing.frame_start = start;
+    const int frames = replay_gles_compatibility_layer_capture(argv[1], end_frame, &timing);
+    if (frames < 0) {
+        ERR("Unable To Read Capture: %s", argv[1]);
+    }
+    glFinish();
+    const double total = (double) (get_time() - start) / 1000000.0;
+
+    // Report
+    for (int i = 0; i < timing.frames_size; i++) {
+        printf("Frame %i: %.3f ms\n", i, timing.frames[i]);
+    }
+    printf("Frames: %i\n", frames);
+    printf("Total: %.3f ms\n", total);
+    if (timing.frames_size > 0) {
+        double sum = 0;
+        for (int i = 0; i < timing.frames_size; i++) {
+            sum += timing.frames[i];
+        }
+        qsort(timing.frames, timing.frames_size, sizeof (double), compare_frames);
+        printf("Average: %.3f ms\n", sum / timing.frames_size);
+        printf("Min: %.3f ms\n", timing.frames[0]);
+        printf("Median: %.3f ms\n", timing.frames[timing.frames_size / 2]);
+        printf("95th Percentile: %.3f ms\n", timing.frames[(timing.frames_size * 95) / 100]);
+        printf("Max: %.3f ms\n", timing.frames[timing.frames_size - 1]);
+    }
+    free(timing.frames);
+
+    // Exit
+    glfwDestroyWindow(glfw_window);
+    glfwTerminate();
+}